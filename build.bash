@@ -174,6 +174,11 @@ Targets:
   http-install              Build and install http sample.
   term-install              Build and install term sample.
   echo-install              Build and install echo sample.
+  accept-install            Build and install connection rate benchmark.
+  footprint-install         Build and install idle connection footprint benchmark.
+  accept_retry-install      Build and install accept error recovery check.
+  escape-install            Build and install binary escaping benchmark.
+  queue-install             Build and install outgoing queue benchmark.
 
 NOTE: Samples installed to the 'UNICOMM_ROOT/out/samples/boost-build' 
       subdirectory.
@@ -288,6 +288,11 @@ echo   unicomm-install           Installs unicomm to the prefix location.
 echo   http-install              Build and install http sample.
 echo   term-install              Build and install term sample.
 echo   echo-install              Build and install echo sample.
+echo   accept-install            Build and install connection rate benchmark.
+echo   footprint-install         Build and install idle connection footprint benchmark.
+echo   accept_retry-install      Build and install accept error recovery check.
+echo   escape-install            Build and install binary escaping benchmark.
+echo   queue-install             Build and install outgoing queue benchmark.
 echo.
 echo NOTE: Samples installed to the 'UNICOMM_ROOT/out/samples/boost-build' 
 echo       subdirectory.
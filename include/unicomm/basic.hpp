@@ -46,6 +46,12 @@ typedef unsigned long commid_type;
 
 /** Full message identifier. */
 typedef std::pair<commid_type, messageid_type> full_messageid_type;
+
+/** Message type identifier type. 
+ *
+ *  @see unicomm::register_message_type().
+ */
+typedef size_t message_typeid_type;
 //@}
 
 //@{
@@ -54,6 +60,9 @@ typedef std::string in_buffer_type;
 
 /** Outgoing buffer type. */
 typedef std::string out_buffer_type;
+
+/** Shared immutable outgoing buffer type. */
+typedef boost::shared_ptr<const out_buffer_type> shared_out_buffer_type;
 //@}
 
 /** Auxiliary strings type. */
@@ -92,6 +101,13 @@ inline bool is_infinite_timeout(size_t tout)
  */
 inline messageid_type undefined_messageid(void) { return 0; }
 
+/** Undefined message type identifier. 
+ *
+ *  Means message type is not known by the engine.
+ */
+inline message_typeid_type undefined_message_typeid(void) 
+  { return ~message_typeid_type(0); }
+
 /** Default creator function, can be used with the factory. */
 template <typename T> boost::shared_ptr<T> inline create(void) 
 { 
@@ -126,12 +142,24 @@ inline const std::string& binary_message_format(void)
   static const std::string s = "binary"; return s; 
 }
 
+/** Length prefixed binary message format identifier value. */
+inline const std::string& binary_lp_message_format(void) 
+{ 
+  static const std::string s = "binary_lp"; return s; 
+}
+
 /** Whether binary format used. */
 inline bool is_binary_message_format(const std::string& format) 
 { 
   return format == binary_message_format(); 
 }
 
+/** Whether length prefixed binary format used. */
+inline bool is_binary_lp_message_format(const std::string& format) 
+{ 
+  return format == binary_lp_message_format(); 
+}
+
 /** Whether xml format used. */
 inline bool is_xml_message_format(const std::string& format) 
 { 
@@ -141,7 +169,8 @@ inline bool is_xml_message_format(const std::string& format)
 /** Whether custom message format used. */
 inline bool is_custom_message_format(const std::string& format) 
 { 
-  return !is_xml_message_format(format) && !is_binary_message_format(format); 
+  return !is_xml_message_format(format) && !is_binary_message_format(format) && 
+    !is_binary_lp_message_format(format);  
 }
 
 // forward
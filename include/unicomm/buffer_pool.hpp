@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// buffer_pool.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Receive buffers pool.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_BUFFER_POOL_HPP_
+#define UNI_BUFFER_POOL_HPP_
+
+/** @file buffer_pool.hpp Receive buffers pool definition. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/detail/pool_detail.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** Pool of the fixed size buffers used by asynchronous read operations.
+ *
+ *  Buffers released to the pool are reused by subsequent reads instead
+ *  of being allocated again. The number of idle buffers held by the pool
+ *  is limited, buffers released over the limit are freed.
+ *
+ *  @note The interface is thread safe.
+ *
+ *  @see unicomm::config::receive_buffer_size(),
+ *    unicomm::config::receive_buffer_pool_size().
+ */
+class UNICOMM_DECL buffer_pool : private boost::noncopyable
+{
+public:
+  /** Buffer type. */
+  typedef std::vector<char> buffer_type;
+
+  /** Buffer smart pointer type. */
+  typedef boost::shared_ptr<buffer_type> buffer_ptr_type;
+
+public:
+  /** Creates a pool.
+   *
+   *  @param buffer_size Size of the buffers to be handed out.
+   *  @param max_idle Maximum idle buffers count held by the pool.
+   */
+  buffer_pool(size_t buffer_size, size_t max_idle);
+
+public:
+  /** Returns a buffer of buffer_pool::buffer_size() size.
+   *
+   *  Takes an idle buffer if any or allocates a new one otherwise.
+   *
+   *  @return A buffer to be used.
+   */
+  buffer_ptr_type acquire(void);
+
+  /** Returns the buffer to the pool.
+   *
+   *  The buffer is freed if the pool already holds
+   *  the maximum idle buffers count.
+   *
+   *  @param buf Buffer previously obtained by buffer_pool::acquire().
+   */
+  void release(const buffer_ptr_type& buf);
+
+  /** Returns the size of the buffers handed out by the pool.
+   *
+   *  @return Buffer size in bytes.
+   */
+  size_t buffer_size(void) const { return _buffer_size; }
+
+  /** Returns the count of idle buffers held by the pool.
+   *
+   *  @return Idle buffers count.
+   */
+  size_t idle_count(void) const { return _idle.idle_count(); }
+
+  /** How many times an idle buffer has been reused.
+   *
+   *  @return Pool hits count.
+   */
+  size_t hits(void) const { return _idle.hits(); }
+
+  /** How many times a new buffer has been allocated.
+   *
+   *  @return Pool misses count.
+   */
+  size_t misses(void) const { return _idle.misses(); }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  detail::idle_list<buffer_ptr_type> _idle;
+  const size_t _buffer_size;
+};
+
+} // namespace unicomm
+
+#endif // UNI_BUFFER_POOL_HPP_
+
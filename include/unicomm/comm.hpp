@@ -22,9 +22,13 @@
 
 #include <unicomm/config/auto_link.hpp>
 #include <unicomm/comm_buffer.hpp>
+#include <unicomm/buffer_pool.hpp>
 #include <unicomm/config.hpp>
 #include <unicomm/session_base.hpp>
+#include <unicomm/message_stream.hpp>
 #include <unicomm/basic.hpp>
+#include <unicomm/detail/priority_queue_detail.hpp>
+#include <unicomm/detail/spin_mutex_detail.hpp>
 
 #ifdef UNI_VISUAL_CPP
 # pragma warning (push)
@@ -34,7 +38,6 @@
 
 #include <smart/sync_objects.hpp>
 #include <smart/debug_out.hpp>
-#include <smart/stable_priority_queue.hpp>
 
 #ifdef UNI_VISUAL_CPP
 # pragma warning (pop)
@@ -46,8 +49,9 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/system/error_code.hpp>
-#include <boost/thread/mutex.hpp>
 #include <boost/atomic.hpp>
+#include <boost/array.hpp>
+#include <boost/assert.hpp>
 
 #ifdef UNI_VISUAL_CPP
 # pragma warning (push)
@@ -62,7 +66,6 @@
 # endif // UNICOMM_SSL
 #endif // UNI_VISUAL_CPP
 
-#include <boost/array.hpp>
 #include <boost/asio.hpp>
 
 #ifdef UNICOMM_SSL
@@ -73,6 +76,12 @@
 # pragma warning (pop)
 #endif // UNI_VISUAL_CPP
 
+#if !defined(UNICOMM_SSL) && !defined(BOOST_ASIO_HAS_IOCP)
+// a reactor reports the readiness, so a receive buffer is taken 
+// only when there is data to read, idle connections hold no buffers
+# define UNICOMM_LAZY_RECEIVE_BUFFER
+#endif // !UNICOMM_SSL && !BOOST_ASIO_HAS_IOCP
+
 #include <map>
 #include <vector>
 #include <string>
@@ -120,6 +129,9 @@ public:
   /** Communicator smart pointer type. */
   typedef comm_pointer_type comm_ptr;
 
+  /** Strand type the communicator's handlers are serialized by. */
+  typedef boost::asio::io_service::strand strand_type;
+
 #ifdef UNICOMM_SSL
   /** Asio handshake handler type. */
   typedef boost::function<void (const boost::system::error_code&)> 
@@ -229,6 +241,169 @@ public:
   messageid_type send(const message_base &message, 
                       const message_sent_handler_type& handler) const;
 
+  /** Puts the message into outgoing queue sharing encoded data.
+   *
+   *  Used to broadcast a message. Unicomm intrinsic.
+   *
+   *  @param message Message to be sent.
+   *  @param out_buffer Encoded message data. If it's empty the message is 
+   *    encoded and, if the encoder doesn't depend on the session, 
+   *    the result is stored there to be reused by the next call.
+   *  @return Message identifier assigned to a given message by the unicomm.
+   *
+   *  @throw Throw the same as unicomm::message_base::serialize() implementation.
+   *  @note Thread safe.
+   *  @see unicomm::message_encoder_base::session_dependent().
+   */
+  messageid_type send_broadcast(const message_base &message, 
+                                shared_out_buffer_type& out_buffer);
+
+  /** Puts the message into outgoing queue sharing encoded data.
+   *
+   *  Used to broadcast a message. Unicomm intrinsic.
+   *
+   *  @param message Message to be sent.
+   *  @param out_buffer Encoded message data. If it's empty the message is 
+   *    encoded and, if the encoder doesn't depend on the session, 
+   *    the result is stored there to be reused by the next call.
+   *  @param handler Handler to be called when the message is sent. 
+   *  @return Message identifier assigned to a given message by the unicomm.
+   *
+   *  @throw Throw the same as unicomm::message_base::serialize() implementation.
+   *  @note Thread safe.
+   *  @see unicomm::message_encoder_base::session_dependent().
+   */
+  messageid_type send_broadcast(const message_base &message, 
+                                shared_out_buffer_type& out_buffer, 
+                                const message_sent_handler_type& handler);
+
+  /** Puts already encoded data into outgoing queue.
+   *
+   *  The data is written to the socket as is, it's neither serialized nor
+   *  encoded, so it should be a complete frame of the protocol the peer
+   *  expects. Useful to relay frames received from somewhere else.
+   *  The buffer is shared, not copied, so it can be queued on
+   *  several communicators at once. The data mustn't be changed
+   *  until it's sent.
+   *
+   *  @param data Encoded data to be sent, shouldn't be empty.
+   *  @param priority Priority of the data in outgoing queue. If it's
+   *    undefined and unicomm::config::use_default_message_priority() is
+   *    set, unicomm::config::default_priority() is used.
+   *
+   *  @param handler Handler to be called when the data is sent. 
+   *    The handler is called once when the data is sent.
+   *
+   *  @return Identifier assigned to the data by the unicomm. It's not sent,
+   *    but passed to the sent handlers to identify the sent data.
+   *
+   *  @note Thread safe. The data is never treated as a request, so it
+   *    doesn't wait for a reply and never times out.
+   *  @see unicomm::session_base::message_sent_handler().
+   */
+  messageid_type send_raw(const shared_out_buffer_type& data, 
+    size_t priority = undefined_priority(), 
+    const message_sent_handler_type& handler = message_sent_handler_type());
+
+  /** Puts already encoded data into outgoing queue.
+   *
+   *  @param data Encoded data to be sent, shouldn't be empty.
+   *  @param priority Priority of the data in outgoing queue.
+   *  @param handler Handler to be called when the data is sent. 
+   *  @return Identifier assigned to the data by the unicomm.
+   *
+   *  @throw unicomm::session_not_found is thrown, if the communicator 
+   *    is already closed.
+   *
+   *  @note Thread safe.
+   *  @see send_raw(const shared_out_buffer_type&, size_t, const message_sent_handler_type&).
+   */
+  messageid_type send_raw(const shared_out_buffer_type& data, 
+    size_t priority = undefined_priority(), 
+    const message_sent_handler_type& handler = message_sent_handler_type()) const;
+
+  /** Puts already encoded data into outgoing queue.
+   *
+   *  The data is taken over by swapping, not copied, so the given buffer
+   *  is empty on return.
+   *
+   *  @param data Encoded data to be sent, shouldn't be empty.
+   *  @param priority Priority of the data in outgoing queue.
+   *  @param handler Handler to be called when the data is sent. 
+   *  @return Identifier assigned to the data by the unicomm.
+   *
+   *  @note Thread safe.
+   *  @see send_raw(const shared_out_buffer_type&, size_t, const message_sent_handler_type&).
+   */
+  messageid_type send_raw(out_buffer_type& data, 
+    size_t priority = undefined_priority(), 
+    const message_sent_handler_type& handler = message_sent_handler_type());
+
+  /** Puts already encoded data into outgoing queue.
+   *
+   *  The data is taken over by swapping, not copied, so the given buffer
+   *  is empty on return.
+   *
+   *  @param data Encoded data to be sent, shouldn't be empty.
+   *  @param priority Priority of the data in outgoing queue.
+   *  @param handler Handler to be called when the data is sent. 
+   *  @return Identifier assigned to the data by the unicomm.
+   *
+   *  @throw unicomm::session_not_found is thrown, if the communicator 
+   *    is already closed.
+   *
+   *  @note Thread safe.
+   *  @see send_raw(const shared_out_buffer_type&, size_t, const message_sent_handler_type&).
+   */
+  messageid_type send_raw(out_buffer_type& data, 
+    size_t priority = undefined_priority(), 
+    const message_sent_handler_type& handler = message_sent_handler_type()) const;
+
+  /** Puts the stream into outgoing queue.
+   *
+   *  The data of the stream is read and written by chunks as the previous 
+   *  chunk is written, so the connection holds no more than a chunk of it
+   *  in memory. The chunks are written as is, like the data passed to
+   *  send_raw(). Unless the stream is unicomm::message_stream::self_delimited()
+   *  the chunks are written one after another and the messages queued 
+   *  are written when the stream ends.
+   *
+   *  @param stream Stream to be sent.
+   *  @param priority Priority of the stream in outgoing queue. If it's
+   *    undefined and unicomm::config::use_default_message_priority() is
+   *    set, unicomm::config::default_priority() is used.
+   *
+   *  @param handler Handler to be called when the last chunk is sent. 
+   *
+   *  @return Identifier assigned to the stream by the unicomm. It's passed 
+   *    to the sent handlers once the whole stream is sent.
+   *
+   *  @note Thread safe. An exception thrown by the stream is passed to 
+   *    the error handler and the rest of the stream isn't sent.
+   *  @see unicomm::message_stream, unicomm::file_stream, 
+   *    unicomm::config::stream_chunk_size().
+   */
+  messageid_type send_stream(const message_stream::pointer_type& stream, 
+    size_t priority = undefined_priority(), 
+    const message_sent_handler_type& handler = message_sent_handler_type());
+
+  /** Puts the stream into outgoing queue.
+   *
+   *  @param stream Stream to be sent.
+   *  @param priority Priority of the stream in outgoing queue.
+   *  @param handler Handler to be called when the last chunk is sent. 
+   *  @return Identifier assigned to the stream by the unicomm.
+   *
+   *  @throw unicomm::session_not_found is thrown, if the communicator 
+   *    is already closed.
+   *
+   *  @note Thread safe.
+   *  @see send_stream(const message_stream::pointer_type&, size_t, const message_sent_handler_type&).
+   */
+  messageid_type send_stream(const message_stream::pointer_type& stream, 
+    size_t priority = undefined_priority(), 
+    const message_sent_handler_type& handler = message_sent_handler_type()) const;
+
   /** Processes outgoing messages and receives incoming if there are.
    *
    *  @throw Different types derived from std::exception are thrown.
@@ -236,7 +411,8 @@ public:
    *    unicomm::disallowed_reply_error is thrown if reply is not allowed.
    *
    *  @note If user handler throws something not derived from std::exception
-   *    debug will assert.
+   *    debug will assert. Should only be invoked through 
+   *    unicomm::communicator::strand().
    */
   void mt_process(void);
 
@@ -329,6 +505,30 @@ public:
    */
   dispatcher& owner(void) const;
 
+  /** Returns the strand the communicator is bound to.
+   *
+   *  Asio handlers and processing of the communicator are all executed 
+   *  through this strand, so they never run concurrently.
+   *  Unicomm intrinsic.
+   *
+   *  @return A reference to the communicator's strand.
+   */
+  strand_type& strand(void) { return _strand; }
+
+  /** Returns the index of the owner's io service the communicator is bound to.
+   *
+   *  Unicomm intrinsic.
+   *
+   *  @see unicomm::config::dispatcher_io_services().
+   */
+  size_t shard(void) const { return _shard; }
+
+  /** Sets the index of the owner's io service the communicator is bound to.
+   *
+   *  Unicomm intrinsic. Should only be set by the owner once on creation.
+   */
+  void shard(size_t index) { _shard = index; }
+
   /** Whether something income data to be processed.
    *
    *  @return Returns true if there is some income got from channel,
@@ -340,11 +540,61 @@ public:
   /** Whether something outgoing data to be processed.
    *
    *  @return Returns true if there is some outgoing data in the buffer
-   *    to be sent, otherwise returns false.
+   *    to be sent and no write operation is in progress, 
+   *    otherwise returns false.
    */
   bool mt_is_unprocessed_outgoing(void) const 
     { return is_ready_to_write(); }
 
+  /** Marks the communicator as having something to be processed.
+   *
+   *  Unicomm intrinsic. 
+   *
+   *  @return Returns true if the communicator is neither queued nor being 
+   *    processed at the moment, so it should be put into the dispatcher's 
+   *    ready queue. Otherwise returns false.
+   */
+  bool mt_signal_ready(void) { return _ready_events++ == 0; }
+
+  /** Returns the number of events signaled since the last processing.
+   *
+   *  Unicomm intrinsic. 
+   */
+  int mt_ready_events(void) const { return _ready_events; }
+
+  /** Acknowledges the given number of events as processed.
+   *
+   *  Unicomm intrinsic. 
+   *
+   *  @param events Events count got by mt_ready_events() before processing.
+   *  @return Returns true if there were new events signaled while processing,
+   *    so the communicator should be put into the ready queue again.
+   */
+  bool mt_ack_ready(int events) { return (_ready_events -= events) != 0; }
+
+  /** Notifies the communicator the message timeout has elapsed.
+   *
+   *  Unicomm intrinsic. Called by the dispatcher's timing wheel. 
+   *  The timeout handler is called on the next processing unless 
+   *  the reply has been received meanwhile.
+   *
+   *  @param mid Message identifier.
+   *  @param serial Serial number the timeout has been scheduled with.
+   */
+  void timeout_elapsed(messageid_type mid, size_t serial);
+
+  /** Restores the state the communicator has been created with.
+   *
+   *  Unicomm intrinsic. Called by unicomm::comm_pool when the last 
+   *  reference to the communicator is released, so the object can serve 
+   *  the next connection. The socket is closed, the communicator gets 
+   *  a new identifier. The session object is kept only if 
+   *  unicomm::session_base::recyclable() returns true.
+   *
+   *  @see unicomm::config::comm_pool_size().
+   */
+  void recycle(void);
+
 public:
 
   // fixme: resolve via friend declarations
@@ -442,36 +692,71 @@ private:
   // interface
   public:
     prepeared_message(messageid_type id = undefined_messageid(),
-      const std::string& name = "", size_t priority = undefined_priority(),
-        const out_buffer_type& out_buffer = ""):
+      message_typeid_type type = undefined_message_typeid(),
+        size_t priority = undefined_priority(),
+          const shared_out_buffer_type& out_buffer = shared_out_buffer_type(),
+            const message_stream::pointer_type& stream = message_stream::pointer_type(),
+              bool partial = false):
       _id(id),
-      _name(name),
+      _type(type),
       _priority(priority),
-      _out_buffer(out_buffer)
+      _out_buffer(out_buffer),
+      _header_len(0),
+      _stream(stream),
+      _partial(partial)
     {
       // empty
     }
 
   public:
     messageid_type id(void) const { return _id; }
-    const std::string& name(void) const { return _name; }
+    message_typeid_type type(void) const { return _type; }
     size_t priority(void) const { return _priority; }
-    const out_buffer_type& out_buffer(void) const { return _out_buffer; }
+    const out_buffer_type& out_buffer(void) const { return *_out_buffer; }
+    // frame header written ahead of the out buffer
+    const char* header(void) const { return _header.data(); }
+    size_t header_len(void) const { return _header_len; }
+
+    void encode_header(message_encoder_base& encoder, session_base& session)
+    { 
+      _header_len = encoder.encode_frame_header(*_out_buffer, _header.data(), session);
+
+      BOOST_ASSERT(_header_len <= _header.size() && " - Frame header is too long");
+    }
+    const message_stream::pointer_type& stream(void) const { return _stream; }
+    bool partial(void) const { return _partial; }
+    // the next chunk is to be read from the stream
+    bool pending_stream(void) const { return _stream && !_out_buffer; }
+
+    void swap(prepeared_message& other)
+    {
+      std::swap(_id, other._id);
+      std::swap(_type, other._type);
+      std::swap(_priority, other._priority);
+      _out_buffer.swap(other._out_buffer);
+      _header.swap(other._header);
+      std::swap(_header_len, other._header_len);
+      _stream.swap(other._stream);
+      std::swap(_partial, other._partial);
+    }
 
   //////////////////////////////////////////////////////////////////////////
   // private stuff
   private:
     messageid_type _id;
-    std::string _name;
+    message_typeid_type _type;
     size_t _priority;
-    out_buffer_type _out_buffer;
+    // may be shared by the messages broadcast to several connections
+    shared_out_buffer_type _out_buffer;
+    // the header is of the connection, so the out buffer stays shared
+    boost::array<char, message_encoder_base::max_frame_header_len> _header;
+    size_t _header_len;
+    // set for the stream and for its chunks
+    message_stream::pointer_type _stream;
+    // the chunk isn't the last one, so it isn't notified as sent
+    bool _partial;
   };
 
-  friend bool operator<(const communicator::prepeared_message& l, 
-    const communicator::prepeared_message& r);
-  friend bool operator>(const communicator::prepeared_message& l, 
-    const communicator::prepeared_message& r);
-
   //////////////////////////////////////////////////////////////////////////
   // timeout message info
   struct message_timeout_info
@@ -479,19 +764,24 @@ private:
   //////////////////////////////////////////////////////////////////////////
   // interface
   public:
-    explicit message_timeout_info(const std::string& name = "", 
-                                  const smart::timeout& tout = smart::timeout()):
-        _name(name), _tout(tout) { /*empty*/ }
+    explicit message_timeout_info(
+      message_typeid_type type = undefined_message_typeid(), 
+        size_t tout = infinite_timeout(), size_t serial = 0):
+      _type(type), _tout(tout), _serial(serial) { /*empty*/ }
 
   public:
-    const std::string& name(void) const { return _name; }
-    const smart::timeout& tout(void) const { return _tout; }
+    message_typeid_type type(void) const { return _type; }
+    size_t tout(void) const { return _tout; }
+    size_t serial(void) const { return _serial; }
 
   //////////////////////////////////////////////////////////////////////////
   // private stuff
   private:
-    std::string _name;
-    smart::timeout _tout;
+    message_typeid_type _type;
+    // elapsing is tracked by the timing wheel, so the clock isn't read here
+    size_t _tout;
+    // tells the timing wheel entry of this very registration
+    size_t _serial;
   };
 
   //////////////////////////////////////////////////////////////////////////
@@ -503,20 +793,20 @@ private:
   public:
     sent_message_info(messageid_type int_mid, 
                       messageid_type mid, 
-                      const std::string& name):
-      _int_mid(int_mid), _mid(mid), _name(name) { /*empty*/ }
+                      message_typeid_type type):
+      _int_mid(int_mid), _mid(mid), _type(type) { /*empty*/ }
 
   public:
     messageid_type int_id(void) const { return _int_mid; }
     messageid_type id(void) const { return _mid; }
-    const std::string& name(void) const { return _name; }
+    message_typeid_type type(void) const { return _type; }
 
   //////////////////////////////////////////////////////////////////////////
   // private stuff
   private:
     messageid_type _int_mid;
     messageid_type _mid;
-    std::string _name;
+    message_typeid_type _type;
   };
 
 private:
@@ -525,22 +815,17 @@ private:
 
   typedef std::map<messageid_type, message_timeout_info> 
     messages_timeouts_map_type;
-  typedef boost::array<char, 0x10000> local_buffer_type;
-  typedef boost::shared_ptr<local_buffer_type> local_buffer_ptr_type;
+  typedef std::vector<std::pair<messageid_type, size_t> > 
+    elapsed_timeouts_type;
+  typedef buffer_pool::buffer_ptr_type receive_buffer_ptr_type;
 
-  typedef smart::sync_queue<
-    prepeared_message,
-    smart::stable_priority_queue<
-      prepeared_message,
-      std::deque<prepeared_message>, std::greater<prepeared_message> >
-  > prepeared_messages_queue_type;
+  typedef detail::bucket_priority_queue<prepeared_message> 
+    prepeared_messages_queue_type;
 
   typedef std::map<messageid_type, prepeared_message> out_buffers_map_type;
+  typedef std::vector<messageid_type> out_buffers_ids_type;
+  typedef std::vector<boost::asio::const_buffer> out_buffers_sequence_type;
   typedef std::vector<sent_message_info> sent_messages_vector_type;
-  typedef boost::mutex mutex_type;
-  typedef mutex_type this_mutex_type;
-  typedef mutex_type in_buffer_mutex_type;
-  typedef mutex_type out_buffer_mutex_type;
 
 private:
   //////////////////////////////////////////////////////////////////////////
@@ -561,22 +846,28 @@ private:
   void process_connect(void);
 
   void mt_process_arrived(void);
-  void mt_process_sent(void);
-  void mt_process_errors(void);
+  void process_sent(void);
+  void process_errors(void);
 
   //////////////////////////////////////////////////////////////////////////
   // aux
-  messageid_type prepare_to_write(const message_base &message);
+  messageid_type prepare_to_write(const message_base &message, 
+    shared_out_buffer_type& out_buffer);
   inline bool is_prepeared_message_queue_empty(void) const;
   /*inline*/ bool is_ready_to_write(void) const;
-  inline void push_prepeared_message(const prepeared_message& m);
-  prepeared_message pop_prepeared_message(void);
+  inline void push_prepeared_message(prepeared_message& m);
+  void pop_prepeared_message(prepeared_message& m);
+  void next_prepeared_message(prepeared_message& m);
+  void read_stream_chunk(prepeared_message& m);
+  messageid_type push_raw(const shared_out_buffer_type& data, 
+    const message_stream::pointer_type& stream, size_t priority, 
+    const message_sent_handler_type& handler);
 
   message_base::pointer_type mt_perform_decode(void);
 
   //////////////////////////////////////////////////////////////////////////
   // timeouts support
-  void reg_message_timeout(messageid_type mid, const std::string& name) const;
+  void reg_message_timeout(messageid_type mid, message_typeid_type type);
   bool is_timeout_registered(messageid_type id) const;
   void unreg_message_timeout(messageid_type id);
   void unreg_message_timeout(messages_timeouts_map_type::iterator it);
@@ -588,10 +879,6 @@ private:
   inline sent_messages_vector_type::iterator unreg_sent_message(
     sent_messages_vector_type::iterator it);
   /*inline*/ bool is_sent_messages_empty(void) const;
-  /*inline*/ bool mt_is_sent_messages_empty(void) const;
-  void mt_reg_sent_message(messageid_type int_mid);
-  inline sent_messages_vector_type::iterator mt_unreg_sent_message(
-    sent_messages_vector_type::iterator it);
 
   void connected(bool c);
 
@@ -605,9 +892,8 @@ private:
     { return !is_sent_messages_empty(); }
   bool is_undefined_priority(size_t priority) const 
     { return priority == undefined_priority(); }
-
-  bool mt_is_write_completed_successfully(void) const 
-    { return !mt_is_sent_messages_empty(); }
+  // out buffer is only held while asio writes it
+  bool is_writing(void) const { return !is_out_buffers_empty(); }
 
   bool just_connected(void) const { return _just_connected; }
   void just_connected(bool jc) { _just_connected = jc; }
@@ -640,24 +926,18 @@ private:
 
   //////////////////////////////////////////////////////////////////////////
   // outgoing buffer support
-  messageid_type out_buffers_insert(const prepeared_message& m);
+  messageid_type out_buffers_insert(prepeared_message& m);
   void out_buffers_erase(messageid_type int_mid);
   const prepeared_message& get_out_buffers_item(messageid_type mid) const;
   bool is_out_buffers_empty(void) const;
 
-  messageid_type mt_out_buffers_insert(const prepeared_message& m);
-  void mt_out_buffers_erase(messageid_type int_mid);
-  const prepeared_message& mt_get_out_buffers_item(messageid_type mid) const;
-  bool mt_is_out_buffers_empty(void) const;
-
   messageid_type new_internal_mid(void) { return _internal_mid++; }
 
-  void mt_handle_ch_error(void);
+  void handle_ch_error(void);
 
 #ifdef UNICOMM_SSL
 
   void handle_handshake_error(void);
-  void mt_handle_handshake_error(void);
   void handle_handshake(const boost::system::error_code& error);
 
 #endif // UNICOMM_SSL
@@ -676,9 +956,15 @@ private:
   //////////////////////////////////////////////////////////////////////////
   // boost asio handlers
   void mt_asio_read_handler(const boost::system::error_code& error, size_t n, 
-    const local_buffer_ptr_type& buf_ptr);
-  void mt_asio_write_handler(const boost::system::error_code& error, 
-    messageid_type mid);
+    const receive_buffer_ptr_type& buf_ptr);
+
+#ifdef UNICOMM_LAZY_RECEIVE_BUFFER
+
+  void mt_asio_readable_handler(const boost::system::error_code& error);
+
+#endif // UNICOMM_LAZY_RECEIVE_BUFFER
+
+  void mt_asio_write_handler(const boost::system::error_code& error);
 
   void handle_connected_success(void);
 
@@ -700,26 +986,27 @@ private:
 private:
   //////////////////////////////////////////////////////////////////////////
   // data
-  this_mutex_type _this_mutex;
-  mutable out_buffer_mutex_type _out_buf_mutex;
-  mutex_type _read_err_mutex;
-  mutex_type _write_err_mutex;
-  mutex_type _hshake_err_mutex;
-  // access should be always synchronized (one/multi threaded)
-  // due to external access is possible
-  mutable mutex_type _session_mutex;
-  mutable mutex_type _sent_mes_mutex;
-
+  // serializes asio handlers and processing, 
+  // the rest of the data below is only accessed through it
+  strand_type _strand;
   socket_type _socket;
   commid_type _id;
   mutable comm_buffer _in_buffer;
-  local_buffer_type _local_buffer;
   sent_messages_vector_type _sent_messages;
-  prepeared_messages_queue_type _prepeared_m_queue;
+  // filled by any thread, drained through the strand only
+  mutable prepeared_messages_queue_type _prepeared_m_queue;
   out_buffers_map_type _out_buffers;
+  // the stream to be written next, through the strand only
+  prepeared_message _out_stream;
+  // internal ids of the messages being written by the pending write
+  out_buffers_ids_type _write_batch;
   //volatile mutable messageid_type _mesid;
   mutable boost::atomic<messageid_type> _mesid;
   mutable messages_timeouts_map_type _mes_timeouts;
+  size_t _timeout_serial;
+  // filled by the dispatcher's timing wheel
+  detail::spin_mutex _elapsed_mutex;
+  elapsed_timeouts_type _elapsed_timeouts;
 
   //////////////////////////////////////////////////////////////////////////
   // flags
@@ -737,10 +1024,17 @@ private:
   //volatile bool _just_connected;
   boost::atomic<bool> _just_connected;
   session_base::pointer_type _user_session;
+  // session is created once through the strand, 
+  // the flag publishes it to the external threads
+  boost::atomic<bool> _session_valid;
   const unicomm::config* _config;
   dispatcher& _owner;
   //volatile bool _in_buffer_updated;
   boost::atomic<bool> _in_buffer_updated;
+  // events signaled but not processed yet
+  boost::atomic_int _ready_events;
+  // owner's io service index
+  size_t _shard;
 
 #ifdef UNICOMM_FORK_SUPPORT
 
@@ -21,22 +21,123 @@
 /** @file comm_buffer.hpp Communicator buffer definition. */
 
 #include <unicomm/config/auto_link.hpp>
-
-#include <boost/thread/mutex.hpp>
+#include <unicomm/detail/spin_mutex_detail.hpp>
 
 #include <string>
+#include <cstddef>
 
 /** @namespace unicomm Unicomm library root namespace. */
 namespace unicomm
 {
 
-/** Communicator buffer provides thread safe operations on buffer. */
+/** Read only contiguous view of the buffered data. 
+ *
+ *  Provides a subset of std::string search interface, so decoders 
+ *  can look for message bounds without copying the data.
+ *
+ *  @note The view is valid until the buffer is modified.
+ */
+class UNICOMM_DECL buffer_view
+{
+public:
+  /** Iterator type. */
+  typedef const char* const_iterator;
+
+  /** Iterator type. */
+  typedef const_iterator iterator;
+
+  /** Size type. */
+  typedef std::string::size_type size_type;
+
+public:
+  /** Creates a view of the given range. 
+   *
+   *  @param first Begin of the data.
+   *  @param last End of the data.
+   *  @param scanned Length of the head already scanned by a decoder.
+   */
+  buffer_view(const_iterator first, const_iterator last, size_type scanned = 0): 
+    _begin(first), 
+    _end(last),
+    _scanned(scanned)
+  { 
+    // empty
+  }
+
+public:
+  /** Returns an iterator to the first element. */
+  const_iterator begin(void) const { return _begin; }
+
+  /** Returns an iterator past the last element. */
+  const_iterator end(void) const { return _end; }
+
+  /** Returns the view length. */
+  size_type size(void) const { return static_cast<size_type>(_end - _begin); }
+
+  /** Whether the view is empty. */
+  bool empty(void) const { return _begin == _end; }
+
+  /** Returns the length of the head already scanned by the decoder. 
+   *
+   *  It's the position the search for the end of the message may 
+   *  resume at, the head is known not to contain one.
+   *
+   *  @see unicomm::message_decoder_base::scanned_length().
+   */
+  size_type scanned(void) const { return _scanned; }
+
+  /** Returns the element at the given position. */
+  char operator[](size_type pos) const { return _begin[pos]; }
+
+  /** Finds the first occurrence of the character. 
+   *
+   *  @param c Character to search for.
+   *  @param pos Position to start the search at.
+   *  @return Position of the character or std::string::npos if not found.
+   */
+  size_type find(char c, size_type pos = 0) const;
+
+  /** Finds the first occurrence of the string. 
+   *
+   *  @param s String to search for.
+   *  @param pos Position to start the search at.
+   *  @return Position of the string or std::string::npos if not found.
+   */
+  size_type find(const std::string& s, size_type pos = 0) const;
+
+  /** Returns a copy of the part of the data. 
+   *
+   *  @param pos Position of the first character.
+   *  @param n Characters count, truncated to the view's end.
+   *  @return Requested data.
+   */
+  std::string substr(size_type pos, size_type n = std::string::npos) const;
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  const_iterator _begin;
+  const_iterator _end;
+  size_type _scanned;
+};
+
+/** Communicator buffer provides thread safe operations on buffer. 
+ *
+ *  Incoming data is appended to the tail and consumed from the head.
+ *  Consuming just advances the head, the storage is compacted only 
+ *  when the consumed part outweighs the rest, so taking a message 
+ *  out of the buffer costs the message length rather than 
+ *  the whole buffer length.
+ */
 class UNICOMM_DECL comm_buffer
 {
 public:
   /** Actual buffer type that provides specific operations. */
   typedef std::string buffer_type;
 
+  /** Contiguous view type. */
+  typedef buffer_view view_type;
+
 public:
   /** Provides thread safe access to the internal buffer. */
   struct buffer_lock
@@ -57,8 +158,30 @@ public:
      *  Thread safe.
      *  
      *  @return Returns a reference to the internal buffer object.
+     *  @note Drops already consumed data, prefer buffer_lock::view() 
+     *    and buffer_lock::consume() to avoid moving the data.
+     */
+    buffer_type& buffer(void) { return _buf->compacted_buffer(); }
+
+    /** Returns a view of the data that is not consumed yet. 
+     *
+     *  @return Buffered data view.
+     */
+    view_type view(void) const { return _buf->inner_view(); }
+
+    /** Removes the given count of bytes from the head of the buffer. 
+     *
+     *  @param n Bytes count to be removed.
+     */
+    void consume(size_t n) { _buf->inner_consume(n); }
+
+    /** Stores the length of the head already scanned by the decoder. 
+     *
+     *  It's reset when the data is consumed.
+     *
+     *  @param n Scanned bytes count.
      */
-    buffer_type& buffer(void) { return _buf->inner_buffer(); }
+    void scanned(size_t n) { _buf->inner_scanned(n); }
 
     /** Unlocks the buffer. */
     void unlock(void) { _lock.unlock(); }
@@ -67,9 +190,13 @@ public:
   // private stuff
   private:
     comm_buffer* _buf;
-    boost::mutex::scoped_lock _lock;
+    detail::spin_mutex::scoped_lock _lock;
   };
 
+public:
+  /** Creates an empty buffer. */
+  comm_buffer(void): _head(0), _scanned(0) { /* empty */ }
+
 public:
   /** Appends tail to the buffer in thread safe manner.
    *
@@ -78,6 +205,21 @@ public:
    */
   comm_buffer& append(const buffer_type& tail);
 
+  /** Appends tail to the buffer in thread safe manner.
+   *
+   *  @param data Data to be appended.
+   *  @param n Data length.
+   *  @return *this.
+   */
+  comm_buffer& append(const char* data, size_t n);
+
+  /** Removes the given count of bytes from the head of the buffer.
+   *
+   *  @param n Bytes count to be removed.
+   *  @return *this.
+   */
+  comm_buffer& consume(size_t n);
+
   /** Swaps the buffer with the object of the internal type. 
    *
    *  @param other The object to swap with. 
@@ -98,6 +240,12 @@ public:
    */
   bool empty(void) const;
 
+  /** Returns buffered data length.
+   *
+   *  @return Bytes count not consumed yet.
+   */
+  size_t size(void) const;
+
   /** Returns a copy of the data. 
    *
    *  @return The internal buffer copy.
@@ -107,14 +255,24 @@ public:
 //////////////////////////////////////////////////////////////////////////
 // private stuff
 private:
-  buffer_type& inner_buffer(void) { return _buffer; }
-  buffer_type& inner_buffer(void) const { return _buffer; }
-  boost::mutex& mutex(void) { return _buf_mutex; }
-  boost::mutex& mutex(void) const { return _buf_mutex; }
+  buffer_type& compacted_buffer(void);
+  view_type inner_view(void) const;
+  void inner_consume(size_t n);
+  void inner_scanned(size_t n);
+  void compact(void);
+  size_t inner_size(void) const { return _buffer.size() - _head; }
+  detail::spin_mutex& mutex(void) { return _buf_mutex; }
+  detail::spin_mutex& mutex(void) const { return _buf_mutex; }
 
 private:
-  mutable boost::mutex _buf_mutex;
-  mutable buffer_type _buffer;
+  // the buffer of a connection is accessed through its strand,
+  // so the lock is uncontended and only has to be small
+  mutable detail::spin_mutex _buf_mutex;
+  buffer_type _buffer;
+  // consumed bytes count at the beginning of the _buffer
+  size_t _head;
+  // bytes count after the _head scanned by the decoder with no message found
+  size_t _scanned;
 };
 
 } // namespace unicomm
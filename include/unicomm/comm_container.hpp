@@ -50,6 +50,9 @@ public:
   /** Communicator identifiers collection type. */
   typedef std::vector<commid_type> commid_collection_type;
 
+  /** Communicator pointers sequence type. */
+  typedef std::vector<comm_ptr> comm_sequence_type;
+
 public:
   /** Takes out a client from the primary collection. 
    *
@@ -84,23 +87,35 @@ public:
    */
   void insert(const comm_ptr& comm);
 
+  /** Inserts several communicators to the collection at once. 
+   *
+   *  The collection is locked once for the whole sequence. 
+   *  Does NOT overwrite existing ones if there are.
+   *
+   *  @param comms Communicators to be inserted to the container.
+   */
+  void insert(const comm_sequence_type& comms);
+
   /** Sends the message to all currently connected clients. 
    *
-   *  Actually calls communicator::send() for each communicator in the 
-   *  collection.
+   *  The message is encoded once and the encoded data is shared by 
+   *  every communicator in the collection, unless the encoder depends 
+   *  on the session.
    *
    *  @param message Message to send.
    *  @return Map of the sent message identifiers. The map contains 
    *    <commid, messagid> pairs. 
    *
    *  @throw The same as unicomm::communicator::send().
+   *  @see unicomm::message_encoder_base::session_dependent().
    */
   full_messageid_map_type send_all(const message_base& message) const;
 
   /** Sends the message to all currently connected clients. 
    *
-   *  Actually calls communicator::send() for each communicator in the 
-   *  collection.
+   *  The message is encoded once and the encoded data is shared by 
+   *  every communicator in the collection, unless the encoder depends 
+   *  on the session.
    *
    *  @param message Message to send.
    *  @param handler Handler to be called when the message is actually sent.
@@ -108,6 +123,7 @@ public:
    *    <commid, messagid> pairs. 
    *
    *  @throw The same as unicomm::communicator::send().
+   *  @see unicomm::message_encoder_base::session_dependent().
    */
   full_messageid_map_type send_all(const message_base& message, 
     const message_sent_handler_type& handler) const;
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+// comm_pool.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Pool of the communicator objects reused by the connections.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_COMM_POOL_HPP_
+#define UNI_COMM_POOL_HPP_
+
+/** @file comm_pool.hpp Pool of the communicator objects. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/basic.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+// forward
+class communicator;
+
+/** Pool of the communicator objects the dispatcher creates.
+ *
+ *  Each io service has a list of idle communicators of its own, since
+ *  a communicator is bound to the io service it's created with.
+ *  A communicator handed out by the pool returns there as soon as the
+ *  last reference to it is released, i.e. when the connection is closed
+ *  and all its handlers are completed. It's restored to the initial state
+ *  by unicomm::communicator::recycle() then. The number of idle objects
+ *  held per io service is limited, objects released over the limit
+ *  are freed.
+ *
+ *  @note The interface is thread safe.
+ *
+ *  @see unicomm::config::comm_pool_size().
+ */
+class UNICOMM_DECL comm_pool : private boost::noncopyable
+{
+public:
+  /** Communicator creator type. */
+  typedef boost::function<communicator* (void)> creator_type;
+
+public:
+  /** Creates a pool.
+   *
+   *  @param shards Count of the io services served.
+   *  @param max_idle Maximum idle objects count held per io service.
+   */
+  comm_pool(size_t shards, size_t max_idle);
+
+  /** Frees idle objects.
+   *
+   *  Communicators handed out are freed as they are released.
+   */
+  ~comm_pool(void);
+
+public:
+  /** Returns a communicator bound to the given io service.
+   *
+   *  Takes an idle object if any or creates a new one otherwise.
+   *
+   *  @param shard Io service index.
+   *  @param creator Creates the communicator if there is no idle one.
+   *  @return Communicator object.
+   */
+  comm_pointer_type acquire(size_t shard, const creator_type& creator);
+
+  /** Fills the idle list of the io service up to the limit.
+   *
+   *  @param shard Io service index.
+   *  @param creator Creates the communicators.
+   */
+  void reserve(size_t shard, const creator_type& creator);
+
+  /** Returns maximum idle objects count held per io service.
+   *
+   *  @return Idle objects limit.
+   */
+  size_t max_idle(void) const { return _max_idle; }
+
+  /** Returns the count of idle objects of the io service.
+   *
+   *  @param shard Io service index.
+   *  @return Idle objects count.
+   */
+  size_t idle_count(size_t shard) const;
+
+  /** How many times an idle object has been reused.
+   *
+   *  @return Pool hits count.
+   */
+  size_t hits(void) const;
+
+  /** How many objects have been created to be handed out.
+   *
+   *  Objects created by unicomm::comm_pool::reserve() aren't counted.
+   *
+   *  @return Pool misses count.
+   */
+  size_t misses(void) const;
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  class shard_pool;
+
+  typedef boost::shared_ptr<shard_pool> shard_pool_ptr;
+  typedef std::vector<shard_pool_ptr> shard_pools_type;
+
+private:
+  // pools are shared with the communicators handed out,
+  // so the communicators are able to outlive this object
+  shard_pools_type _pools;
+  const size_t _max_idle;
+};
+
+} // namespace unicomm
+
+#endif // UNI_COMM_POOL_HPP_
@@ -24,6 +24,7 @@
 #include <unicomm/message_base.hpp>
 #include <unicomm/message_decoder_base.hpp>
 #include <unicomm/message_encoder_base.hpp>
+#include <unicomm/message_types.hpp>
 #include <unicomm/session_base.hpp>
 #include <unicomm/basic.hpp>
 
@@ -31,6 +32,7 @@
 #include <boost/asio/ip/tcp.hpp>
 
 #include <string>
+#include <vector>
 #include <map>
 
 /** @namespace unicomm Unicomm library root namespace. */
@@ -139,7 +141,14 @@ class UNICOMM_DECL config
 //////////////////////////////////////////////////////////////////////////
 // interface
 public:
-  /** Constructs a configuration object. 
+  /** Message type identifiers collection type. */
+  typedef std::vector<message_typeid_type> message_types_type;
+
+  /** Listening endpoints collection type. */
+  typedef std::vector<boost::asio::ip::tcp::endpoint> endpoints_type;
+
+public:
+  /** Constructs a configuration object.  
    *
    *  @param session_factory User's session factory method. 
    *  @param message_factory Messages factory.
@@ -197,6 +206,76 @@ public:
    */
   int tcp_backlog(void) const { return _tcp_backlog; }
 
+  /** Count of the listening sockets the server opens on every endpoint. 
+   *
+   *  If it's more than 1 (one) every socket is bound to the same endpoint 
+   *  with SO_REUSEPORT option, so the system spreads incoming connections 
+   *  across them. Each listening socket is served by its own io service, 
+   *  the sockets are assigned to the io services in turn, and the 
+   *  connections accepted by the socket stay on its io service. 
+   *  Where SO_REUSEPORT isn't supported the only socket is opened.
+   *
+   *  @return Listening sockets count.
+   *  @note Default value is 1 (one). 0 (zero) is treated as 1 (one).
+   *
+   *  @see unicomm::config::server_pending_accepts(), 
+   *    unicomm::config::dispatcher_io_services().
+   */
+  size_t server_acceptors(void) const { return _server_acceptors; }
+
+  /** Count of the accept operations kept pending on a listening socket. 
+   *
+   *  Several pending accepts let the connections from the backlog be taken 
+   *  by several threads at once. Each completed accept is replaced 
+   *  by a new one.
+   *
+   *  @return Pending accepts per listening socket.
+   *  @note Default value is 1 (one). 0 (zero) is treated as 1 (one).
+   *
+   *  @see unicomm::config::server_acceptors().
+   */
+  size_t server_pending_accepts(void) const { return _server_pending_accepts; }
+
+  /** Maximum count of the connections taken at once by a completed accept. 
+   *
+   *  When an accept completes the listening socket is most likely to have 
+   *  more connections in the backlog. They are taken by non-blocking 
+   *  accepts until the backlog is empty or this count is reached. 
+   *  The connections taken are added to the dispatcher at once.
+   *
+   *  @return Connections count to be accepted per wakeup.
+   *  @note Default value is 16. 0 (zero) is treated as 1 (one), 
+   *    i.e. one connection per accept.
+   *
+   *  @see unicomm::config::server_pending_accepts().
+   */
+  size_t server_accept_burst(void) const { return _server_accept_burst; }
+
+  /** Endpoints the server listens to. 
+   *
+   *  The server opens unicomm::config::server_acceptors() listening sockets 
+   *  on every endpoint. IPv4 and IPv6 endpoints can be mixed. All of them 
+   *  share the server's dispatcher, io services and threads.
+   *
+   *  @return Listening endpoints.
+   *  @note Default value is empty collection. If empty the server 
+   *    listens to unicomm::config::endpoint() only.
+   *
+   *  @see unicomm::config::server_ipv6_only().
+   */
+  const endpoints_type& listen_endpoints(void) const { return _listen_endpoints; }
+
+  /** Whether IPv6 listening sockets accept IPv6 connections only. 
+   *
+   *  If false an IPv6 socket is dual-stack, so the socket bound to the 
+   *  IPv6 any address (::) also accepts IPv4 connections. 
+   *  Set it to listen to both IPv4 and IPv6 any address on the same port.
+   *
+   *  @return True if IPv6 sockets are IPv6 only and false otherwise.
+   *  @note Default value is false. Doesn't affect IPv4 sockets.
+   */
+  bool server_ipv6_only(void) const { return _server_ipv6_only; }
+
   /** Default messages timeout in milliseconds.
    *
    *  In case when configuration loaded from file
@@ -249,10 +328,30 @@ public:
    *
    *  @return Message format identifier string.
    *  @see unicomm::set_binary_message_format(), unicomm::set_xml_message_format(),
+   *    unicomm::set_binary_lp_message_format(),
    *    unicomm::load_from_complex_xml(), unicomm::setup_message_format().
    */
   const std::string& message_format(void) const { return _message_format; }
 
+  /** Maximum length of the incoming message. 
+   *
+   *  If there is more data buffered than the limit and no message is 
+   *  recognized yet, the error handler is called with 
+   *  unicomm::message_too_long_error description and the connection 
+   *  is closed. So the peer can't make the connection buffer 
+   *  an endless message. The length prefixed binary 
+   *  format checks the length header instead, before the message data 
+   *  arrives, the header is not counted then. 0 (zero) means no limit, 
+   *  but the length prefixed binary format is limited by 16 MiB then.
+   *
+   *  @return Maximum incoming message length in bytes.
+   *  @note Default value is 0 (zero).
+   *  @note The limit is passed to the length prefixed binary decoder 
+   *    by unicomm::set_binary_lp_message_format(), so set it before.
+   *  @see unicomm::message_decoder_base::limits_message_length().
+   */
+  size_t max_message_length(void) const { return _max_message_length; }
+
 public:
   /** Whether message with given name is configured for reply waiting.
    *
@@ -339,6 +438,90 @@ public:
   size_t message_priority(const std::string& mesname) const 
     { return mes_info(mesname).priority(); }
 
+public:
+  /** Returns message type identifier for the given name. 
+   *
+   *  Message names specified by unicomm::config::message_info() including 
+   *  the allowed answers are interned when they are set, so the policies 
+   *  of the message type are looked up by the identifier. 
+   *  Those lookups are just an array access.
+   *
+   *  @param mesname Message name.
+   *  @return Message type identifier or unicomm::undefined_message_typeid()
+   *    if the name is unknown by the configuration. Policies of undefined 
+   *    message type are the defaults as for unknown message name.
+   *
+   *  @see unicomm::register_message_type().
+   */
+  message_typeid_type message_type(const std::string& mesname) const;
+
+  /** Returns message type identifier of the message. 
+   *
+   *  The identifier is taken from unicomm::message_base::type_id() if it's 
+   *  already resolved. Otherwise message name is looked up and the 
+   *  identifier found is stored to the message.
+   *
+   *  @param m Message to get type identifier of.
+   *  @return Message type identifier or unicomm::undefined_message_typeid()
+   *    if the message is unknown by the configuration.
+   *
+   *  @see unicomm::message_base::type_id().
+   */
+  message_typeid_type message_type(const message_base& m) const;
+
+  /** Whether reply is needed for the message type. 
+   *
+   *  @param type Message type identifier.
+   *  @return The same as unicomm::config::need_reply() for the message name.
+   *  @see unicomm::config::message_type().
+   */
+  bool need_reply(message_typeid_type type) const 
+    { return mes_info(type).need_reply(); }
+
+  /** Timeout value for the message type. 
+   *
+   *  @param type Message type identifier.
+   *  @return The same as unicomm::config::message_timeout() for 
+   *    the message name.
+   *
+   *  @see unicomm::config::message_type().
+   */
+  size_t message_timeout(message_typeid_type type) const 
+    { return timeouts_enabled()? mes_info(type).timeout(): infinite_timeout(); }
+
+  /** Whether timeout is used for the message type. 
+   *
+   *  @param type Message type identifier.
+   *  @return The same as unicomm::config::message_timeout_used() for 
+   *    the message name.
+   *
+   *  @see unicomm::config::message_type().
+   */
+  bool message_timeout_used(message_typeid_type type) const 
+    { return message_timeout(type) != infinite_timeout(); }
+
+  /** Allowed answers of the message type. 
+   *
+   *  @param type Message type identifier.
+   *  @return Sorted type identifiers of the messages allowed to be a reply. 
+   *    Empty collection allows everything.
+   *
+   *  @see unicomm::config::message_answers(), unicomm::is_allowed_reply().
+   */
+  const message_types_type& message_answer_types(message_typeid_type type) const 
+    { return mes_policy(type).answers; }
+
+  /** Returns message priority for the message type. 
+   *
+   *  @param type Message type identifier.
+   *  @return The same as unicomm::config::message_priority() for 
+   *    the message name.
+   *
+   *  @see unicomm::config::message_type().
+   */
+  size_t message_priority(message_typeid_type type) const 
+    { return mes_info(type).priority(); }
+
   /** Returns session factory object. 
    *
    *  @return User's session objects factory.
@@ -414,6 +597,21 @@ public:
    */
   size_t dispatcher_idle_tout(void) const { return _working_th_sleep_tout; }
 
+  /** Whether every connection is processed each dispatcher idle timeout. 
+   *
+   *  Connections are only processed when something happens to them: 
+   *  data arrives or is sent, a message is queued or a reply timeout 
+   *  elapses. Set it if the sessions rely on the after processed handler 
+   *  being called periodically, e.g. to track their own timeouts. 
+   *  It costs a pass over all the connections every 
+   *  unicomm::config::dispatcher_idle_tout() milliseconds.
+   *
+   *  @return True if all the connections are processed periodically.
+   *  @note Default value is false.
+   */
+  bool dispatcher_idle_process_all(void) const 
+    { return _dispatcher_idle_process_all; }
+
   /** Incoming message processing time quantum per client.
    *
    *  It means if there are incoming data it's only processed for this
@@ -435,9 +633,200 @@ public:
    *
    *  @return Time quantum to process outgoing data for the each connection.
    *  @note Default value is 100 milliseconds.
+   *
+   *  @see unicomm::config::outgoing_batch_messages(), 
+   *    unicomm::config::outgoing_batch_bytes().
    */
   size_t outgoing_quantum(void) const { return _outgoing_quantum; }
 
+  /** Maximum number of dispatcher's processing passes pending at a time. 
+   *
+   *  Every read, write, send and etc. requests the dispatcher to process.
+   *  Requests are coalesced, so if the limit of pending processing passes 
+   *  is reached the request doesn't post another one, it's served by 
+   *  one of already pending passes. Use 1 (one) to have at most one 
+   *  pending pass regardless of the working threads count.
+   *
+   *  @return Pending processing passes limit.
+   *  @note Default value is 0 (zero). It means one pending pass per thread 
+   *    executing unicomm::dispatcher::run().
+   *
+   *  @see unicomm::dispatcher::stats(), unicomm::dispatcher_stats.
+   */
+  size_t dispatcher_pending_kicks(void) const { return _dispatcher_pending_kicks; }
+
+  /** Number of io services the dispatcher's connections are spread across. 
+   *
+   *  If there is only one io service all the threads executing 
+   *  unicomm::dispatcher::run() share it. Otherwise each connection is 
+   *  bound to one of the io services (shards) and threads are assigned 
+   *  to the io services having the fewest threads as they call 
+   *  unicomm::dispatcher::run(). This avoids contention on the single 
+   *  reactor and handlers queue.
+   *
+   *  @return Io services count.
+   *  @note Default value is 1 (one).
+   *  @note @b IMPORTANT! Start at least as many threads executing 
+   *    unicomm::dispatcher::run() as io services. Connections are only 
+   *    bound to the io services having a thread, so the rest of them 
+   *    stay idle. Connections created before any thread is started 
+   *    are bound to the first io service.
+   *
+   *  @see unicomm::config::dispatcher_least_loaded(), 
+   *    unicomm::config::dispatcher_pin_threads().
+   */
+  size_t dispatcher_io_services(void) const { return _dispatcher_io_services; }
+
+  /** Whether new connections are bound to the least loaded io service. 
+   *
+   *  Least loaded is the one serving the fewest connections. 
+   *  Otherwise io services are taken in round-robin order.
+   *  Only makes sense if unicomm::config::dispatcher_io_services() 
+   *  is greater than 1 (one).
+   *
+   *  @return True if least loaded io service is chosen.
+   *  @note Default value is false.
+   */
+  bool dispatcher_least_loaded(void) const { return _dispatcher_least_loaded; }
+
+  /** Whether threads executing unicomm::dispatcher::run() are pinned to cpus. 
+   *
+   *  The thread running the io service N is pinned to the cpu N modulo 
+   *  the count of cpus, so with a thread per io service each io service 
+   *  is served by its own cpu. Only supported on Linux, ignored otherwise.
+   *
+   *  @return True if threads are pinned.
+   *  @note Default value is false.
+   *
+   *  @see unicomm::config::dispatcher_io_services().
+   */
+  bool dispatcher_pin_threads(void) const { return _dispatcher_pin_threads; }
+
+  /** Size of the buffer used by a single asynchronous read operation. 
+   *
+   *  Bounds the amount of data read from a socket at once. Smaller 
+   *  buffers reduce memory held by pending reads of idle connections, 
+   *  larger ones reduce the number of reads of bulk transfers.
+   *
+   *  @return Receive buffer size in bytes.
+   *  @note Default value is 65536 bytes.
+   *
+   *  @see unicomm::config::receive_buffer_pool_size().
+   */
+  size_t receive_buffer_size(void) const { return _receive_buffer_size; }
+
+  /** Maximum number of idle receive buffers kept for reuse. 
+   *
+   *  Receive buffers are taken from the pool of the io service 
+   *  the connection is bound to and returned there as soon as the read 
+   *  data is consumed, so the io services don't contend for a pool. 
+   *  The buffers returned while the pool holds this many idle ones are freed.
+   *  0 (zero) disables pooling, every read allocates its own buffer then.
+   *
+   *  @return Idle receive buffers limit per io service.
+   *  @note Default value is 64.
+   *
+   *  @see unicomm::dispatcher::stats(), unicomm::dispatcher_stats.
+   */
+  size_t receive_buffer_pool_size(void) const { return _receive_buffer_pool_size; }
+
+  /** Maximum number of idle received message objects kept for reuse per type. 
+   *
+   *  If it's not 0 (zero), received messages are taken from the decoder's 
+   *  pool and returned there as soon as the last reference to the message 
+   *  is released, usually when the message arrived handler returns. 
+   *  Only the message types declaring reset support by 
+   *  unicomm::message_base::resettable() are pooled. A reused message 
+   *  is reset by unicomm::message_base::reset() only, so a type 
+   *  declaring the support must clear there all the data 
+   *  unicomm::message_base::unserialize() doesn't overwrite, e.g. 
+   *  optional fields and containers, otherwise the data of the previous 
+   *  message is carried over. 0 (zero) disables pooling, 
+   *  every received message is created by the factory then.
+   *
+   *  @return Idle messages limit per message type.
+   *  @note Default value is 0 (zero).
+   *
+   *  @see unicomm::message_pool, unicomm::message_decoder_base::pool(), 
+   *    unicomm::dispatcher::stats().
+   */
+  size_t message_pool_size(void) const { return _message_pool_size; }
+
+  /** Maximum number of idle communicators kept for reuse per io service. 
+   *
+   *  If it's not 0 (zero), a communicator released after its connection 
+   *  is closed isn't destroyed but is kept to serve the next accepted 
+   *  or connected one. The pool is filled up when the server or client 
+   *  is created, so the connections don't allocate communicators until 
+   *  this count is exceeded. The session object is kept with the 
+   *  communicator if unicomm::session_base::recyclable() tells so, 
+   *  it's prepared for the next connection by 
+   *  unicomm::session_base::reset() instead of the session factory.
+   *  0 (zero) disables pooling.
+   *
+   *  @return Idle communicators limit per io service.
+   *  @note Default value is 0 (zero). The pool isn't used when the 
+   *    library is built with SSL support, the SSL stream can't serve 
+   *    another connection.
+   *
+   *  @see unicomm::comm_pool, unicomm::dispatcher::stats().
+   */
+  size_t comm_pool_size(void) const { return _comm_pool_size; }
+
+  /** Maximum number of queued messages written to a socket at once. 
+   *
+   *  Messages waiting in the outgoing queue of a connection are gathered 
+   *  into a single write operation which is served by one system call 
+   *  and one completion. Message sent notifications of the whole batch 
+   *  are issued as the write completes. 0 (zero) and 1 (one) both mean 
+   *  every message is written separately.
+   *
+   *  @return Messages per write limit.
+   *  @note Default value is 64.
+   *
+   *  @see unicomm::config::outgoing_batch_bytes().
+   */
+  size_t outgoing_batch_messages(void) const { return _outgoing_batch_messages; }
+
+  /** Maximum number of bytes gathered into a single socket write. 
+   *
+   *  No more messages are added to the batch once its size reaches 
+   *  the limit. A batch contains at least one message regardless of 
+   *  its size. 0 (zero) means no limit.
+   *
+   *  @return Bytes per write limit.
+   *  @note Default value is 65536 bytes.
+   *
+   *  @see unicomm::config::outgoing_batch_messages().
+   */
+  size_t outgoing_batch_bytes(void) const { return _outgoing_batch_bytes; }
+
+  /** Maximum size of the chunk read from an outgoing stream. 
+   *
+   *  A stream is written by chunks, a chunk per socket write, so 
+   *  a connection holds no more than one chunk of the stream in memory. 
+   *
+   *  @return Chunk size limit in bytes.
+   *  @note Default value is 65536 bytes.
+   *
+   *  @see unicomm::communicator::send_stream(), unicomm::message_stream.
+   */
+  size_t stream_chunk_size(void) const { return _stream_chunk_size; }
+
+  /** Message timeouts detection resolution in milliseconds. 
+   *
+   *  Message timeouts are scheduled by the dispatcher's timing wheel 
+   *  which moves on once per this period. A timeout is detected 
+   *  at most one period later than it elapses. Finer resolution makes 
+   *  timeouts more precise at the cost of more frequent timer wake ups.
+   *
+   *  @return Timing wheel tick duration in milliseconds.
+   *  @note Default value is 10 milliseconds.
+   *
+   *  @see unicomm::config::timeouts_enabled().
+   */
+  size_t timeouts_resolution(void) const { return _timeouts_resolution; }
+
 public:
   /** Returns message decoder object. 
    *
@@ -542,6 +931,66 @@ public:
    */
   config& tcp_backlog(int backlog);
 
+  /** Sets count of the listening sockets the server opens. 
+   *
+   *  @param n Listening sockets count.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::server_acceptors() getter.
+   */
+  config& server_acceptors(size_t n) 
+    { _server_acceptors = n; return *this; }
+
+  /** Sets count of the accept operations pending on a listening socket. 
+   *
+   *  @param n Pending accepts per listening socket.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::server_pending_accepts() getter.
+   */
+  config& server_pending_accepts(size_t n) 
+    { _server_pending_accepts = n; return *this; }
+
+  /** Sets count of the connections taken at once by a completed accept. 
+   *
+   *  @param n Connections count to be accepted per wakeup.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::server_accept_burst() getter.
+   */
+  config& server_accept_burst(size_t n) 
+    { _server_accept_burst = n; return *this; }
+
+  /** Sets the endpoints the server listens to. 
+   *
+   *  @param endpoints Listening endpoints.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::listen_endpoints() getter.
+   */
+  config& listen_endpoints(const endpoints_type& endpoints) 
+    { _listen_endpoints = endpoints; return *this; }
+
+  /** Adds an endpoint to the ones the server listens to. 
+   *
+   *  @param ep Listening endpoint.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::listen_endpoints() getter.
+   */
+  config& add_listen_endpoint(const boost::asio::ip::tcp::endpoint& ep) 
+    { _listen_endpoints.push_back(ep); return *this; }
+
+  /** Sets whether IPv6 listening sockets accept IPv6 connections only. 
+   *
+   *  @param v6_only Whether IPv6 sockets are IPv6 only.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::server_ipv6_only() getter.
+   */
+  config& server_ipv6_only(bool v6_only) 
+    { _server_ipv6_only = v6_only; return *this; }
+
   /** Sets messages default priority. 
    *
    *  @param priority Default message priority.
@@ -625,6 +1074,16 @@ public:
    */
   config& message_format(const std::string& format);
 
+  /** Sets maximum length of the incoming message. 
+   *
+   *  @param length Maximum incoming message length in bytes.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::max_message_length() getter.
+   */
+  config& max_message_length(size_t length) 
+    { _max_message_length = length; return *this; }
+
   /** @brief Indicates whether to use unique message identifier for 
    *    every message to be sent. 
    *
@@ -657,6 +1116,16 @@ public:
   config& dispatcher_idle_tout(size_t tout) 
     { _working_th_sleep_tout = tout; return *this; }
 
+  /** Sets whether every connection is processed each dispatcher idle timeout. 
+   *
+   *  @param process_all Whether to process all the connections periodically.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::dispatcher_idle_process_all() getter.
+   */
+  config& dispatcher_idle_process_all(bool process_all) 
+    { _dispatcher_idle_process_all = process_all; return *this; }
+
   /** Incoming message processing time quantum per client. 
    *
    *  @param quantum Time quantum to process incoming messages.
@@ -677,6 +1146,128 @@ public:
   config& outgoing_quantum(size_t quantum) 
     { _outgoing_quantum = quantum; return *this; }
 
+  /** Sets maximum number of dispatcher's processing passes pending at a time. 
+   *
+   *  @param kicks Pending processing passes limit.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::dispatcher_pending_kicks() getter.
+   */
+  config& dispatcher_pending_kicks(size_t kicks) 
+    { _dispatcher_pending_kicks = kicks; return *this; }
+
+  /** Sets number of io services the dispatcher's connections are spread across. 
+   *
+   *  @param n Io services count. 0 (zero) is treated as 1 (one).
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::dispatcher_io_services() getter.
+   */
+  config& dispatcher_io_services(size_t n) 
+    { _dispatcher_io_services = n; return *this; }
+
+  /** Sets whether new connections are bound to the least loaded io service. 
+   *
+   *  @param least_loaded Whether to choose the least loaded io service.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::dispatcher_least_loaded() getter.
+   */
+  config& dispatcher_least_loaded(bool least_loaded) 
+    { _dispatcher_least_loaded = least_loaded; return *this; }
+
+  /** Sets whether threads executing unicomm::dispatcher::run() are pinned to cpus. 
+   *
+   *  @param pin Whether to pin the threads.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::dispatcher_pin_threads() getter.
+   */
+  config& dispatcher_pin_threads(bool pin) 
+    { _dispatcher_pin_threads = pin; return *this; }
+
+  /** Sets the size of the buffer used by a single asynchronous read operation. 
+   *
+   *  @param size Receive buffer size in bytes. 0 (zero) is treated as 
+   *    the default value.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::receive_buffer_size() getter.
+   */
+  config& receive_buffer_size(size_t size) 
+    { _receive_buffer_size = size; return *this; }
+
+  /** Sets maximum number of idle receive buffers kept for reuse. 
+   *
+   *  @param n Idle receive buffers limit.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::receive_buffer_pool_size() getter.
+   */
+  config& receive_buffer_pool_size(size_t n) 
+    { _receive_buffer_pool_size = n; return *this; }
+
+  /** Sets maximum number of idle received message objects kept for reuse per type. 
+   *
+   *  @param n Idle messages limit per message type.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::message_pool_size() getter.
+   */
+  config& message_pool_size(size_t n);
+
+  /** Sets maximum number of idle communicators kept for reuse per io service. 
+   *
+   *  @param n Idle communicators limit per io service.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::comm_pool_size() getter.
+   */
+  config& comm_pool_size(size_t n) 
+    { _comm_pool_size = n; return *this; }
+
+  /** Sets maximum number of queued messages written to a socket at once. 
+   *
+   *  @param n Messages per write limit.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::outgoing_batch_messages() getter.
+   */
+  config& outgoing_batch_messages(size_t n) 
+    { _outgoing_batch_messages = n; return *this; }
+
+  /** Sets maximum number of bytes gathered into a single socket write. 
+   *
+   *  @param n Bytes per write limit.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::outgoing_batch_bytes() getter.
+   */
+  config& outgoing_batch_bytes(size_t n) 
+    { _outgoing_batch_bytes = n; return *this; }
+
+  /** Sets maximum size of the chunk read from an outgoing stream. 
+   *
+   *  @param n Chunk size limit in bytes. 0 (zero) is treated as 
+   *    the default value.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::stream_chunk_size() getter.
+   */
+  config& stream_chunk_size(size_t n) 
+    { _stream_chunk_size = n; return *this; }
+
+  /** Sets message timeouts detection resolution. 
+   *
+   *  @param resolution Timing wheel tick duration in milliseconds. 
+   *    0 (zero) is treated as the default value.
+   *  @return *this.
+   *  @note To find out more details see the 
+   *    unicomm::config::timeouts_resolution() getter.
+   */
+  config& timeouts_resolution(size_t resolution) 
+    { _timeouts_resolution = resolution; return *this; }
+
   /** Sets message factory to be used to create messages. 
    *
    *  @param factory Message factory.
@@ -748,9 +1339,28 @@ public:
 //////////////////////////////////////////////////////////////////////////
 // private stuff
 private:
-  typedef std::map<std::string, unicomm::message_info> messages_map_type;
+  // message type policies, indexed by the message type identifier
+  struct message_policy
+  {
+    explicit message_policy(
+      const unicomm::message_info& i = unicomm::message_info("")): 
+      declared(false), info(i) { /*empty*/ }
+
+    bool declared;
+    unicomm::message_info info;
+    message_types_type answers;
+  };
 
-  const unicomm::message_info& mes_info(const std::string &mesname) const;
+  typedef std::map<std::string, message_typeid_type> message_types_map_type;
+  typedef std::vector<message_policy> message_policies_type;
+
+  const message_policy& mes_policy(message_typeid_type type) const;
+  const unicomm::message_info& mes_info(message_typeid_type type) const
+    { return mes_policy(type).info; }
+  const unicomm::message_info& mes_info(const std::string &mesname) const
+    { return mes_info(message_type(mesname)); }
+
+  message_typeid_type intern_message_type(const std::string& name);
 
   bool message_decoder_exists(void) const;
 
@@ -760,7 +1370,13 @@ private:
   unsigned short _tcp_port;
   boost::asio::ip::tcp::endpoint _endpoint;
   int _tcp_backlog;
-  messages_map_type _messages;
+  size_t _server_acceptors;
+  size_t _server_pending_accepts;
+  size_t _server_accept_burst;
+  endpoints_type _listen_endpoints;
+  bool _server_ipv6_only;
+  message_types_map_type _message_types;
+  message_policies_type _message_policies;
   std::string _file_message_name;
   size_t _def_tout;
   size_t _def_priority;
@@ -771,11 +1387,25 @@ private:
   session_base::factory_type _session_factory;
   message_base::factory_type _message_factory;
   std::string _message_format;
+  size_t _max_message_length;
   bool _use_unique_message_id;
   bool _use_default_message_priority;
   size_t _working_th_sleep_tout;
+  bool _dispatcher_idle_process_all;
   size_t _incoming_quantum;
   size_t _outgoing_quantum;
+  size_t _dispatcher_pending_kicks;
+  size_t _dispatcher_io_services;
+  bool _dispatcher_least_loaded;
+  bool _dispatcher_pin_threads;
+  size_t _receive_buffer_size;
+  size_t _receive_buffer_pool_size;
+  size_t _message_pool_size;
+  size_t _comm_pool_size;
+  size_t _outgoing_batch_messages;
+  size_t _outgoing_batch_bytes;
+  size_t _stream_chunk_size;
+  size_t _timeouts_resolution;
 
 #ifdef UNICOMM_SSL
 
@@ -807,6 +1437,23 @@ UNICOMM_DECL bool is_allowed_reply(const config& conf,
                                    const std::string& request_name, 
                                    const std::string& reply_name);
 
+/** Whether given reply type is allowed.
+ *
+ *  Does the same as the overload taking names, but the allowed answers 
+ *  are looked up by the message type identifiers.
+ *
+ *  @param conf Protocol configuration object reference.
+ *  @param request_type Request type identifier that reply is received to.
+ *  @param reply_type Reply type identifier to test whether it is allowed.
+ *  @return True if reply presents in answers or answers is empty, 
+ *    otherwise false is returned.
+ *
+ *  @see unicomm::config::message_answer_types(), unicomm::config::message_type().
+ */
+UNICOMM_DECL bool is_allowed_reply(const config& conf, 
+                                   message_typeid_type request_type, 
+                                   message_typeid_type reply_type);
+
 /** Sets up binary message format to be used by the configuration. 
  *
  *  It creates and sets up necessary decoders and encoders.
@@ -816,6 +1463,18 @@ UNICOMM_DECL bool is_allowed_reply(const config& conf,
  */
 UNICOMM_DECL config& set_binary_message_format(config& conf);
 
+/** Sets up length prefixed binary message format to be used by the configuration. 
+ *
+ *  It creates and sets up necessary decoders and encoders. Messages are 
+ *  the same as used by the binary format, but framed by the length header 
+ *  instead of the end marker, so there is no escaping.
+ *  
+ *  @param conf Configuration object to be setup.
+ *  @return conf.
+ *  @see unicomm::config::max_message_length().
+ */
+UNICOMM_DECL config& set_binary_lp_message_format(config& conf);
+
 } // namespace unicomm
 
 #endif // UNI_CONFIG_HPP_
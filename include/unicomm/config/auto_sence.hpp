@@ -117,8 +117,21 @@
 # define UNICOMM_USE_COMPLEX_XML 
 #endif // UNICOMM_DYN_LINK
 
+//////////////////////////////////////////////////////////////////////////
+// SIMD fast paths
+// Define UNICOMM_NO_SIMD to use portable code only
+
+#if !defined (UNICOMM_NO_SIMD) && (defined (__SSE2__) || defined (_M_X64) || \
+  (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+# define UNICOMM_SSE2
+#endif // UNICOMM_NO_SIMD
+
+#if !defined (UNICOMM_NO_SIMD) && defined (__AVX2__)
+# define UNICOMM_AVX2
+#endif // UNICOMM_NO_SIMD
+
 #ifdef UNICOMM_DEBUG_VERBOSE 
-# include <smart/debug_out.hpp> 
+# include <smart/debug_out.hpp>  
 # define UNICOMM_DEBUG_OUT(expr) SMART_MT_DEBUG_OUT(expr)
 # define UNICOMM_IFDEF_DEBUG(expr) SMART_IFDEF_DEBUG(expr)
 #else // UNICOMM_DEBUG_VERBOSE 
@@ -0,0 +1,219 @@
+///////////////////////////////////////////////////////////////////////////////
+// pool_detail.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Idle objects list shared by the object pools.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_POOL_DETAIL_HPP_
+#define UNI_POOL_DETAIL_HPP_
+
+/** @file pool_detail.hpp Idle objects list shared by the object pools. */
+
+#include <boost/shared_ptr.hpp>
+#include <boost/pool/pool_alloc.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include <cstddef>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** @namespace detail Unicomm library implementation details. */
+namespace detail
+{
+
+/** Limited list of the idle objects kept for reuse.
+ *
+ *  Counts how many times an idle object has been taken (hits) and
+ *  how many objects have been created because there was none (misses).
+ *  Objects are created and destroyed by the owner outside the lock.
+ *
+ *  @tparam T Object handle type, a pointer or a smart pointer.
+ *  @note The interface is thread safe.
+ */
+template <typename T>
+class idle_list : private boost::noncopyable
+{
+//////////////////////////////////////////////////////////////////////////
+// interface
+public:
+  /** Idle objects container type. */
+  typedef std::vector<T> objects_type;
+
+public:
+  /** Creates a list holding up to max_idle objects. */
+  explicit idle_list(size_t max_idle):
+    _max_idle(max_idle),
+    _closed(false),
+    _hits(0),
+    _misses(0)
+  {
+    // empty
+  }
+
+public:
+  /** Takes an idle object.
+   *
+   *  @param obj Receives the object.
+   *  @return False if there is no idle object, obj isn't changed then.
+   */
+  bool acquire(T& obj)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+
+    if (_idle.empty())
+    {
+      return false;
+    }
+
+    using std::swap;
+    swap(obj, _idle.back());
+
+    _idle.pop_back();
+    ++_hits;
+
+    return true;
+  }
+
+  /** Puts the object to the list.
+   *
+   *  @param obj Object to be kept.
+   *  @return False if the list is full or closed, the object
+   *    isn't taken then.
+   */
+  bool release(const T& obj)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+
+    if (_closed || _idle.size() >= _max_idle)
+    {
+      return false;
+    }
+
+    _idle.push_back(obj);
+
+    return true;
+  }
+
+  /** Whether an object released now wouldn't be taken. */
+  bool full(void) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+
+    return _closed || _idle.size() >= _max_idle;
+  }
+
+  /** Takes all the idle objects out, the ones released later aren't taken.
+   *
+   *  @param idle Receives the idle objects.
+   */
+  void close(objects_type& idle)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+
+    _closed = true;
+    _idle.swap(idle);
+  }
+
+  /** Counts an object created as there was no idle one. */
+  void created(void) { ++_misses; }
+
+  /** Returns maximum idle objects count. */
+  size_t max_idle(void) const { return _max_idle; }
+
+  /** Returns idle objects count. */
+  size_t idle_count(void) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+
+    return _idle.size();
+  }
+
+  /** How many times an idle object has been taken. */
+  size_t hits(void) const { return _hits; }
+
+  /** How many objects have been created as there was no idle one. */
+  size_t misses(void) const { return _misses; }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  mutable boost::mutex _mutex;
+  objects_type _idle;
+  const size_t _max_idle;
+  bool _closed;
+  boost::atomic<size_t> _hits;
+  boost::atomic<size_t> _misses;
+};
+
+/** Returns the object to its pool when the last lending reference is released.
+ *
+ *  @tparam PoolPtrT Pool smart pointer type, the pool provides
+ *    release(const HandleT&).
+ *  @tparam HandleT Object handle the pool takes back.
+ */
+template <typename PoolPtrT, typename HandleT>
+class recycler
+{
+public:
+  recycler(const PoolPtrT& pool, const HandleT& obj):
+    _pool(pool),
+    _obj(obj)
+  {
+    // empty
+  }
+
+public:
+  template <typename T>
+  void operator()(T* /*p*/) const
+  {
+    _pool->release(_obj);
+  }
+
+private:
+  // keeps the pool alive, so the objects are able to outlive its owner
+  PoolPtrT _pool;
+  HandleT _obj;
+};
+
+/** Lends the pooled object.
+ *
+ *  Every lending gets a reference counter of its own, so the object
+ *  returns to the pool as soon as the last reference is released.
+ *  The counters are allocated by the pool allocator, so lending
+ *  doesn't involve the heap.
+ *
+ *  @param p Object to be lent.
+ *  @param pool Pool the object is returned to.
+ *  @param obj Handle of the object passed back to the pool.
+ *  @return Lending reference.
+ */
+template <typename T, typename PoolPtrT, typename HandleT>
+boost::shared_ptr<T> lend(T* p, const PoolPtrT& pool, const HandleT& obj)
+{
+  return boost::shared_ptr<T>(p, recycler<PoolPtrT, HandleT>(pool, obj),
+    boost::fast_pool_allocator<T>());
+}
+
+} // namespace detail
+
+} // namespace unicomm
+
+#endif // UNI_POOL_DETAIL_HPP_
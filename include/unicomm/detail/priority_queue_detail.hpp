@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////
+// priority_queue_detail.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Outgoing messages priority queue.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_PRIORITY_QUEUE_DETAIL_HPP_
+#define UNI_PRIORITY_QUEUE_DETAIL_HPP_
+
+/** @file priority_queue_detail.hpp Outgoing messages priority queue. */
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/assert.hpp>
+
+#include <map>
+
+#include <cstddef>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** @namespace detail Unicomm library implementation details. */
+namespace detail
+{
+
+/** Returns the index of the most significant set bit.
+ *
+ *  @param bits Bit mask, can't be zero.
+ */
+inline size_t highest_bit(boost::uint32_t bits)
+{
+  BOOST_ASSERT(bits != 0 && " - No bits are set");
+
+  size_t n = 0;
+
+  if (bits & 0xFFFF0000) { bits >>= 16; n += 16; }
+  if (bits & 0x0000FF00) { bits >>= 8;  n += 8; }
+  if (bits & 0x000000F0) { bits >>= 4;  n += 4; }
+  if (bits & 0x0000000C) { bits >>= 2;  n += 2; }
+  if (bits & 0x00000002) { n += 1; }
+
+  return n;
+}
+
+/** Priority queue preserving the order of elements with equal priority.
+ *
+ *  Elements with greater priority are popped first. Every priority level
+ *  is a FIFO of its own. Levels below bucket_priority_queue::direct_levels
+ *  are addressed directly and a bitmap of non-empty ones is kept,
+ *  greater priorities are held by an ordered map.
+ *
+ *  Any thread may push while the only consumer pops. Pushed elements
+ *  are linked into a lock free inbound list (intrusive MPSC queue by
+ *  Dmitry Vyukov), the consumer moves them to the levels before looking
+ *  at the queue. Elements are never copied by the queue, they are
+ *  swapped in and out.
+ *
+ *  @tparam T Element type. Should be default constructible and provide
+ *    priority() const and swap(T&) members.
+ */
+template <typename T>
+class bucket_priority_queue : private boost::noncopyable
+{
+//////////////////////////////////////////////////////////////////////////
+// interface
+public:
+  /** Stored value type. */
+  typedef T value_type;
+
+  /** Number of the directly addressed priority levels. */
+  static const size_t direct_levels = 32;
+
+public:
+  /** Constructs an empty queue. */
+  bucket_priority_queue(void):
+    _inbound_head(&_stub),
+    _inbound_tail(&_stub),
+    _levels_mask(0)
+  {
+    _stub.next = 0;
+  }
+
+  /** Destroys the queue and all the elements left. */
+  ~bucket_priority_queue(void)
+  {
+    value_type dummy;
+
+    while (pop(dummy)) { /* empty */ }
+  }
+
+public:
+  /** Pushes an element into the queue.
+   *
+   *  @param value Value to be pushed. The value is swapped into the queue,
+   *    so it's left default constructed.
+   *  @note Can be called by any thread.
+   */
+  void push(value_type& value)
+  {
+    node* n = new node;
+
+    n->value.swap(value);
+    push_inbound(n);
+  }
+
+  /** Whether the queue is empty.
+   *
+   *  @return Returns true if there is nothing to be popped.
+   *  @note Consumer only. An element being pushed at the moment
+   *    may be not considered.
+   */
+  bool empty(void)
+  {
+    drain();
+
+    return _levels_mask == 0 && _upper_levels.empty();
+  }
+
+  /** Pops an element with the greatest priority.
+   *
+   *  @param value Receives the element popped.
+   *  @return Returns false if the queue is empty.
+   *  @note Consumer only.
+   */
+  bool pop(value_type& value)
+  {
+    if (empty())
+    {
+      return false;
+    }
+
+    node* n = 0;
+    if (!_upper_levels.empty())
+    {
+      typename upper_levels_type::iterator it = _upper_levels.end();
+
+      n = (--it)->second.pop();
+      if (it->second.empty())
+      {
+        _upper_levels.erase(it);
+      }
+    } else
+    {
+      const size_t level = highest_bit(_levels_mask);
+
+      n = _levels[level].pop();
+      if (_levels[level].empty())
+      {
+        _levels_mask &= ~(boost::uint32_t(1) << level);
+      }
+    }
+
+    value.swap(n->value);
+    delete n;
+
+    return true;
+  }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  struct node
+  {
+    boost::atomic<node*> next;
+    node* level_next;
+    value_type value;
+  };
+
+  struct fifo
+  {
+    fifo(void): first(0), last(0) { /* empty */ }
+
+    bool empty(void) const { return first == 0; }
+
+    void push(node* n)
+    {
+      n->level_next = 0;
+      if (last) { last->level_next = n; } else { first = n; }
+      last = n;
+    }
+
+    node* pop(void)
+    {
+      node* n = first;
+
+      first = n->level_next;
+      if (!first) { last = 0; }
+
+      return n;
+    }
+
+    node* first;
+    node* last;
+  };
+
+  typedef std::map<size_t, fifo> upper_levels_type;
+
+private:
+  void push_inbound(node* n)
+  {
+    n->next.store(0, boost::memory_order_relaxed);
+
+    node* prev = _inbound_head.exchange(n, boost::memory_order_acq_rel);
+    // the list is broken until the link is stored,
+    // the consumer doesn't see this and following nodes till then
+    prev->next.store(n, boost::memory_order_release);
+  }
+
+  node* pop_inbound(void)
+  {
+    node* tail = _inbound_tail;
+    node* next = tail->next.load(boost::memory_order_acquire);
+
+    if (tail == &_stub)
+    {
+      if (!next)
+      {
+        return 0;
+      }
+
+      _inbound_tail = tail = next;
+      next = next->next.load(boost::memory_order_acquire);
+    }
+
+    if (next)
+    {
+      _inbound_tail = next;
+      return tail;
+    }
+
+    if (tail != _inbound_head.load(boost::memory_order_acquire))
+    {
+      // producer is in the middle of the push
+      return 0;
+    }
+
+    push_inbound(&_stub);
+
+    next = tail->next.load(boost::memory_order_acquire);
+    if (next)
+    {
+      _inbound_tail = next;
+      return tail;
+    }
+
+    return 0;
+  }
+
+  void drain(void)
+  {
+    for (node* n = pop_inbound(); n; n = pop_inbound())
+    {
+      const size_t priority = n->value.priority();
+
+      if (priority < direct_levels)
+      {
+        _levels[priority].push(n);
+        _levels_mask |= boost::uint32_t(1) << priority;
+      } else
+      {
+        _upper_levels[priority].push(n);
+      }
+    }
+  }
+
+private:
+  // producers side
+  boost::atomic<node*> _inbound_head;
+  // consumer side
+  node* _inbound_tail;
+  node _stub;
+  boost::uint32_t _levels_mask;
+  fifo _levels[direct_levels];
+  upper_levels_type _upper_levels;
+};
+
+} // namespace detail
+
+} // namespace unicomm
+
+#endif // UNI_PRIORITY_QUEUE_DETAIL_HPP_
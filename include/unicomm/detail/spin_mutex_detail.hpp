@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// spin_mutex_detail.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Compact mutex for the data hardly ever contended.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_SPIN_MUTEX_DETAIL_HPP_
+#define UNI_SPIN_MUTEX_DETAIL_HPP_
+
+/** @file spin_mutex_detail.hpp Spin mutex definition. */
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** @namespace detail Unicomm library implementation details. */
+namespace detail
+{
+
+/** Mutex taking a single byte and no system resources.
+ *
+ *  Every connection owns a few mutexes guarding the data that is
+ *  only contended by accident, since it's mostly accessed through
+ *  the connection's strand. The spinning thread yields, so it's only
+ *  suitable for the short critical sections.
+ *
+ *  @note Satisfies Lockable concept.
+ */
+class spin_mutex : private boost::noncopyable
+{
+public:
+  /** Lock type. */
+  typedef boost::unique_lock<spin_mutex> scoped_lock;
+
+public:
+  /** Creates unlocked mutex. */
+  spin_mutex(void): _locked(false) { /* empty */ }
+
+public:
+  /** Tries to lock the mutex.
+   *
+   *  @return True if locked and false otherwise.
+   */
+  bool try_lock(void)
+  {
+    return !_locked.exchange(true, boost::memory_order_acquire);
+  }
+
+  /** Locks the mutex, waits until it's unlocked by another thread. */
+  void lock(void)
+  {
+    while (!try_lock())
+    {
+      // don't write the shared line while waiting
+      while (_locked.load(boost::memory_order_relaxed))
+      {
+        boost::this_thread::yield();
+      }
+    }
+  }
+
+  /** Unlocks the mutex. */
+  void unlock(void) { _locked.store(false, boost::memory_order_release); }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  boost::atomic<bool> _locked;
+};
+
+} // namespace detail
+
+} // namespace unicomm
+
+#endif // UNI_SPIN_MUTEX_DETAIL_HPP_
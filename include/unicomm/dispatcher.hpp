@@ -25,13 +25,18 @@
 
 #include <unicomm/config/auto_link.hpp>
 #include <unicomm/message_base.hpp>
+#include <unicomm/message_stream.hpp>
 #include <unicomm/basic.hpp>
 #include <unicomm/except.hpp>
 #include <unicomm/comm_container.hpp>
+#include <unicomm/buffer_pool.hpp>
+#include <unicomm/comm_pool.hpp>
+#include <unicomm/timer_wheel.hpp>
 
 #include <smart/sync_objects.hpp>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/assert.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/mutex.hpp>
@@ -39,7 +44,9 @@
 #include <boost/noncopyable.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/atomic.hpp>
+#include <boost/bind.hpp>
 
 #ifdef UNICOMM_FORK_SUPPORT
 # include <boost/asio/signal_set.hpp>
@@ -60,6 +67,7 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <map>
 
 /** @namespace unicomm Unicomm library root namespace. */
@@ -69,6 +77,165 @@ namespace unicomm
 // forward
 class config;
 
+/** Dispatcher's runtime statistics. 
+ *
+ *  Counters are accumulated since the dispatcher is created.
+ *
+ *  @see unicomm::dispatcher::stats().
+ */
+struct dispatcher_stats
+{
+//////////////////////////////////////////////////////////////////////////
+// interface
+public:
+  /** Creates an object with all the counters set to 0 (zero). */
+  dispatcher_stats(void):
+    _kicks_requested(0),
+    _kicks_posted(0),
+    _kicks_handled(0),
+    _buffers_reused(0),
+    _buffers_allocated(0),
+    _messages_reused(0),
+    _messages_created(0),
+    _comms_reused(0),
+    _comms_created(0)
+  {
+    // empty
+  }
+
+public:
+  /** How many times the dispatcher has been requested to process. 
+   *
+   *  @return Processing requests count.
+   */
+  size_t kicks_requested(void) const { return _kicks_requested; }
+
+  /** How many processing passes have been posted to the io service. 
+   *
+   *  Requests made while pending processing passes limit is reached 
+   *  are coalesced and do not post a pass.
+   *
+   *  @return Posted processing passes count.
+   *  @see unicomm::config::dispatcher_pending_kicks().
+   */
+  size_t kicks_posted(void) const { return _kicks_posted; }
+
+  /** How many processing passes have been executed. 
+   *
+   *  @return Executed processing passes count.
+   */
+  size_t kicks_handled(void) const { return _kicks_handled; }
+
+  /** How many times a pooled receive buffer has been reused. 
+   *
+   *  @return Receive buffers pool hits count.
+   *  @see unicomm::config::receive_buffer_pool_size().
+   */
+  size_t buffers_reused(void) const { return _buffers_reused; }
+
+  /** How many receive buffers have been allocated. 
+   *
+   *  @return Receive buffers pool misses count.
+   */
+  size_t buffers_allocated(void) const { return _buffers_allocated; }
+
+  /** How many times a pooled received message object has been reused. 
+   *
+   *  Per message type counters are provided by unicomm::message_pool.
+   *
+   *  @return Received messages pool hits count.
+   *  @see unicomm::config::message_pool_size().
+   */
+  size_t messages_reused(void) const { return _messages_reused; }
+
+  /** How many received message objects have been created by the pool. 
+   *
+   *  @return Received messages pool misses count.
+   */
+  size_t messages_created(void) const { return _messages_created; }
+
+  /** How many times a pooled communicator has been reused. 
+   *
+   *  @return Communicators pool hits count.
+   *  @see unicomm::config::comm_pool_size().
+   */
+  size_t comms_reused(void) const { return _comms_reused; }
+
+  /** How many communicators have been created since the pool was empty. 
+   *
+   *  @return Communicators pool misses count.
+   */
+  size_t comms_created(void) const { return _comms_created; }
+
+public:
+  /** Sets processing requests count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& kicks_requested(size_t n) { _kicks_requested = n; return *this; }
+
+  /** Sets posted processing passes count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& kicks_posted(size_t n) { _kicks_posted = n; return *this; }
+
+  /** Sets executed processing passes count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& kicks_handled(size_t n) { _kicks_handled = n; return *this; }
+
+  /** Sets receive buffers pool hits count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& buffers_reused(size_t n) { _buffers_reused = n; return *this; }
+
+  /** Sets receive buffers pool misses count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& buffers_allocated(size_t n) { _buffers_allocated = n; return *this; }
+
+  /** Sets received messages pool hits count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& messages_reused(size_t n) { _messages_reused = n; return *this; }
+
+  /** Sets received messages pool misses count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& messages_created(size_t n) { _messages_created = n; return *this; }
+
+  /** Sets communicators pool hits count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& comms_reused(size_t n) { _comms_reused = n; return *this; }
+
+  /** Sets communicators pool misses count. 
+   *
+   *  @return *this.
+   */
+  dispatcher_stats& comms_created(size_t n) { _comms_created = n; return *this; }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  size_t _kicks_requested;
+  size_t _kicks_posted;
+  size_t _kicks_handled;
+  size_t _buffers_reused;
+  size_t _buffers_allocated;
+  size_t _messages_reused;
+  size_t _messages_created;
+  size_t _comms_reused;
+  size_t _comms_created;
+}; // struct dispatcher_stats
+
 /** Unicomm communicator manager class. 
  *
  *  Provides communicators collection management. 
@@ -96,6 +263,9 @@ public:
   /** Communicator identifiers collection type. */
   typedef comm_container_type::commid_collection_type commid_collection_type;
 
+  /** Communicator pointers sequence type. */
+  typedef comm_container_type::comm_sequence_type comm_sequence_type;
+
 public:
   /** Constructs an instance of dispatcher.
    *
@@ -128,6 +298,15 @@ public:
    *  parallel by different threads but each connection is processed by single 
    *  thread. Connections are picked up by threads accordingly to concurrency rules, 
    *  i.e. race conditions.
+   *
+   *  If there are several io services configured each calling thread is 
+   *  assigned to the one having the fewest threads and only processes 
+   *  connections bound to that io service. New connections are only bound 
+   *  to the io services having a thread, so start at least 
+   *  unicomm::config::dispatcher_io_services() threads, the rest of 
+   *  io services stay idle otherwise.
+   *
+   *  @see unicomm::config::dispatcher_io_services().
    */
   void run(void);
 
@@ -238,6 +417,45 @@ public:
   messageid_type send_one(commid_type commid, const message_base& message, 
     const message_sent_handler_type& handler);
 
+  /** Sends already encoded data to the remote side of the connection 
+   *  with the given id.
+   *  
+   *  @param commid Connection identifier which the data should be sent to.
+   *  @param data Encoded data to be sent as is, shouldn't be empty.
+   *  @param priority Priority of the data in outgoing queue.
+   *  @param handler Handler to be called when the data is actually sent.
+   *  @return Returns identifier assigned to the data by unicomm engine.
+   *    It's passed to message sent handler.
+   *
+   *  @throw unicomm::session_not_found is thrown, if there is no 
+   *    such connection found.
+   *
+   *  @see unicomm::communicator::send_raw().
+   */
+  messageid_type send_raw_one(commid_type commid, 
+    const shared_out_buffer_type& data, 
+    size_t priority = undefined_priority(),
+    const message_sent_handler_type& handler = message_sent_handler_type());
+
+  /** Sends the stream to the remote side of the connection with the given id.
+   *  
+   *  @param commid Connection identifier which the stream should be sent to.
+   *  @param stream Stream to be sent.
+   *  @param priority Priority of the stream in outgoing queue.
+   *  @param handler Handler to be called when the whole stream is sent.
+   *  @return Returns identifier assigned to the stream by unicomm engine.
+   *    It's passed to message sent handler.
+   *
+   *  @throw unicomm::session_not_found is thrown, if there is no 
+   *    such connection found.
+   *
+   *  @see unicomm::communicator::send_stream().
+   */
+  messageid_type send_stream_one(commid_type commid, 
+    const message_stream::pointer_type& stream, 
+    size_t priority = undefined_priority(),
+    const message_sent_handler_type& handler = message_sent_handler_type());
+
   /** Sends a message to the remote sides of all currently opened connections. 
    *  
    *  @param message Message to be sent.
@@ -323,6 +541,42 @@ public:
    */
   size_t connections_count(void) const;
 
+  /** Returns dispatcher's runtime statistics. 
+   *
+   *  @return A snapshot of the dispatcher's counters.
+   */
+  dispatcher_stats stats(void) const;
+
+  /** Returns the pool the communicators take receive buffers from. 
+   *
+   *  Unicomm intrinsic. Every io service has a pool of its own.
+   *
+   *  @param index Index of the io service the communicator is bound to.
+   *  @return A reference to the receive buffers pool.
+   */
+  buffer_pool& receive_buffers(size_t index) { return shard(index).receive_buffers(); }
+
+  /** Returns the timing wheel the message timeouts are scheduled by. 
+   *
+   *  Unicomm intrinsic.
+   *
+   *  @return A reference to the message timeouts timing wheel.
+   */
+  timer_wheel& message_timeouts(void) { return _message_timeouts; }
+
+  /** Schedules a message timeout. 
+   *
+   *  Unicomm intrinsic. The timing wheel is only moved on while 
+   *  there are timeouts scheduled.
+   *
+   *  @param comm Communicator the timeout belongs to.
+   *  @param mid Message identifier.
+   *  @param serial Serial number to identify the timeout by on expiration.
+   *  @param tout Timeout in milliseconds.
+   */
+  void schedule_message_timeout(const comm_ptr& comm, messageid_type mid, 
+    size_t serial, size_t tout);
+
   // fixme: Add post handler interface
 
 public:
@@ -357,6 +611,17 @@ public:
   /** Wakes up one of the dispatcher's thread. */
   void kick_dispatcher(void);
 
+  // fixme: make protected, resolve via friend declaration
+  /** Puts the communicator into the ready queue and wakes up 
+   *    one of the dispatcher's thread. 
+   *
+   *  Only communicators from the ready queue are processed when the 
+   *  dispatcher is woken up. 
+   *
+   *  @param comm Communicator having something to be processed.
+   */
+  void kick_dispatcher(communicator& comm);
+
 //////////////////////////////////////////////////////////////////////////
 // protected stuff
 protected:
@@ -402,16 +667,13 @@ protected:
    *  @see unicomm::dispatcher::process_client(), unicomm::dispatcher::on_stop(),
    *    unicomm::dispatcher::extra_process().
    */
-  comm_ptr comm(commid_type commid) const { return clients().get(commid); }
+  comm_ptr comm(commid_type commid) const;
 
   /** Retrieves a copy of the communicators collection. 
    *
    *  @return Communicator objects collection.
    */
-  comm_container_type::comm_collection_type communicators(void) const
-  { 
-    return clients().communicators(); 
-  }
+  comm_container_type::comm_collection_type communicators(void) const;
 
   /** Returns a const reference to held endpoint initialized by constructor. 
    *
@@ -435,10 +697,29 @@ protected:
   /** @brief Returns a reference to boost asio io service object which 
    *    connections are served by. 
    *
+   *  If there are several io services this is the first one. 
+   *  It also serves the dispatcher's timer and listening socket.
+   *
    *  @return Reference to boost asio io service object.
    */
   boost::asio::io_service& ioservice(void);
 
+  /** Returns a reference to the io service with the given index. 
+   *
+   *  @param index Io service index, should be less than 
+   *    unicomm::dispatcher::ioservices_count().
+   *  @return Reference to boost asio io service object.
+   *
+   *  @see unicomm::config::dispatcher_io_services().
+   */
+  boost::asio::io_service& ioservice(size_t index);
+
+  /** Returns the count of io services the connections are spread across. 
+   *
+   *  @return Io services count.
+   */
+  size_t ioservices_count(void) const { return shards_count(); }
+
 #ifdef UNICOMM_SSL
 
   /** Returns a reference to boost asio ssl context object. 
@@ -458,6 +739,15 @@ protected:
    */
   void insert_comm(const comm_ptr& comm);
 
+  /** Inserts several communicators to the collection at once. 
+   *
+   *  The communicators are grouped by their io services, so each 
+   *  collection involved is locked once.
+   *
+   *  @param comms Communicators to be added.
+   */
+  void insert_comms(const comm_sequence_type& comms);
+
   //////////////////////////////////////////////////////////////////////////
   // misc handlers
 
@@ -495,15 +785,50 @@ protected:
   template <typename T> 
   comm_ptr create_comm(void)
   {
-#ifdef UNICOMM_SSL
+    // the io service the communicator is bound to for the whole its life
+    return create_comm<T>(next_shard());
+  }
 
-    return comm_ptr(new T(*this, ioservice(), ssl_context(), config()));
+  /** Creates a communicator bound to the given io service. 
+   *
+   *  @tparam The type of the communicator to be created.
+   *  @param index Io service index, should be less than 
+   *    unicomm::dispatcher::ioservices_count().
+   *  @return Smart pointer to newly created communicator object.
+   */
+  template <typename T> 
+  comm_ptr create_comm(size_t index)
+  {
+    BOOST_ASSERT(index < shards_count() && " - Invalid io service index");
 
-#else 
+    comm_ptr comm = _comm_pool? 
+      _comm_pool->acquire(index, boost::bind(&dispatcher::new_comm<T>, this, index)): 
+      comm_ptr(new_comm<T>(index));
 
-    return comm_ptr(new T(*this, ioservice(), config()));
+    comm->shard(index);
 
-#endif // UNICOMM_SSL
+    return comm;
+  }
+
+  /** Fills the communicators pool up. 
+   *
+   *  Creates idle communicators of the specified type for every 
+   *  io service, so the connections don't allocate them. 
+   *  Does nothing if the pool is disabled.
+   *
+   *  @tparam The type of the communicators to be created.
+   *  @see unicomm::config::comm_pool_size().
+   */
+  template <typename T> 
+  void reserve_comms(void)
+  {
+    if (_comm_pool)
+    {
+      for (size_t i = 0; i < shards_count(); ++i)
+      {
+        _comm_pool->reserve(i, boost::bind(&dispatcher::new_comm<T>, this, i));
+      }
+    }
   }
   /// @}
 
@@ -558,6 +883,8 @@ private:
 
 #endif // UNICOMM_SSL
 
+  friend void communicator::recycle(void);
+
 #ifdef UNICOMM_FORK_SUPPORT
 
   friend void communicator::fork_prepare(void) const;
@@ -573,6 +900,103 @@ private:
 
   void after_all_processed_handler(const after_all_processed_handler_type& fn);
 
+private:
+  typedef std::deque<comm_ptr> ready_queue_type;
+
+  //////////////////////////////////////////////////////////////////////////
+  // io service with the communicators bound to it
+  class shard_type : private boost::noncopyable
+  {
+  //////////////////////////////////////////////////////////////////////////
+  // interface
+  public:
+    shard_type(size_t buffer_size, size_t max_idle_buffers): 
+      _kick_count(0), 
+      _run_count(0), 
+      _kicks_requested(0), 
+      _kicks_posted(0), 
+      _kicks_handled(0), 
+      _receive_buffers(buffer_size, max_idle_buffers)
+    { 
+      // empty
+    }
+
+  public:
+    boost::asio::io_service& ioservice(void) { return _ioservice; }
+    comm_container_type& clients(void) { return _clients; }
+    const comm_container_type& clients(void) const { return _clients; }
+
+    void create_work(void);
+    void destroy_work(void);
+
+    // communicators having something to be processed
+    void push_ready(const comm_ptr& comm);
+    bool pop_ready(comm_ptr& comm);
+    void clear_ready(void);
+    size_t ready_count(void) const;
+
+    // pending processing passes
+    boost::atomic_int& kick_count(void) { return _kick_count; }
+    // threads executing the io service
+    boost::atomic_int& run_count(void) { return _run_count; }
+    int run_count(void) const { return _run_count; }
+    // statistics, kept per io service so the threads don't share them
+    boost::atomic<size_t>& kicks_requested(void) { return _kicks_requested; }
+    boost::atomic<size_t>& kicks_posted(void) { return _kicks_posted; }
+    boost::atomic<size_t>& kicks_handled(void) { return _kicks_handled; }
+    size_t kicks_requested(void) const { return _kicks_requested; }
+    size_t kicks_posted(void) const { return _kicks_posted; }
+    size_t kicks_handled(void) const { return _kicks_handled; }
+    // reads on the io service take buffers from it
+    buffer_pool& receive_buffers(void) { return _receive_buffers; }
+    const buffer_pool& receive_buffers(void) const { return _receive_buffers; }
+
+  //////////////////////////////////////////////////////////////////////////
+  // private stuff
+  private:
+    typedef boost::scoped_ptr<boost::asio::io_service::work> work_ptr_type;
+
+  private:
+    // the order matters, communicators should be destroyed before io service
+    boost::asio::io_service _ioservice;
+    work_ptr_type _work;
+    comm_container_type _clients;
+    mutable boost::mutex _ready_mutex;
+    ready_queue_type _ready_queue;
+    boost::atomic_int _kick_count;
+    boost::atomic_int _run_count;
+    boost::atomic<size_t> _kicks_requested;
+    boost::atomic<size_t> _kicks_posted;
+    boost::atomic<size_t> _kicks_handled;
+    buffer_pool _receive_buffers;
+  };
+
+  typedef boost::shared_ptr<shard_type> shard_ptr_type;
+  typedef std::vector<shard_ptr_type> shards_type;
+
+private:
+  //////////////////////////////////////////////////////////////////////////
+  // io services
+  shard_type& shard(size_t index) const { return *_shards[index]; }
+  size_t shards_count(void) const { return _shards.size(); }
+  size_t next_shard(void);
+  size_t take_run_shard(void);
+  void pin_run_thread(size_t index) const;
+
+  template <typename T> 
+  communicator* new_comm(size_t index)
+  {
+#ifdef UNICOMM_SSL
+
+    return new T(*this, shard(index).ioservice(), ssl_context(), config());
+
+#else 
+
+    return new T(*this, shard(index).ioservice(), config());
+
+#endif // UNICOMM_SSL
+  }
+
 private:
   //////////////////////////////////////////////////////////////////////////
   // other aux stuff
@@ -583,10 +1007,15 @@ private:
   void clear_clients(void);
   void create_io_service(void);
   void destroy_io_service(void);
+  void stop_io_service(void);
   void disconnect_client(communicator& comm);
   void actually_disconnect_all(void);
   //bool client_exists(commid_type id) const;
-  void process_clients(void);
+  void process_clients(size_t index);
+  void process_ready_comm(const comm_ptr& comm);
+  void signal_ready(communicator& comm);
+  void signal_all_ready(void);
+  void clear_ready_comms(void);
   void set_event_handlers(void);
   void create_service_work(void);
   void destroy_service_work(void);
@@ -603,12 +1032,11 @@ private:
   void redeem_timer(void);
   void destroy_timer(void);
   void timer_handler(const boost::system::error_code& error);
+  void arm_wheel_timer(void);
+  void redeem_wheel_timer(void);
+  void wheel_timer_handler(const boost::system::error_code& error);
 
-  /** Returns a clients collection. */
-  comm_container_type& clients(void) { return _clients; }
-  const comm_container_type& clients(void) const { return _clients; }
   bool remove_client(commid_type id);
-  bool client_exists(commid_type id) const;
   //void deffered_remove_client(commid_type id);
 
   bool is_working(void) const { return _is_working; }
@@ -616,11 +1044,9 @@ private:
   void set_is_working(void) { is_working(true); }
   void clear_is_working(void) { is_working(false); }
 
-  //void inc_kick_count(void);
-  void dec_kick_count(void) { --_kick_count; }
-  size_t kick_count(void) const { return _kick_count; }
-  bool can_kick(void) const 
-    { return (_kick_count < run_count()? ++_kick_count, true: false); }
+  void kick_shard(size_t index);
+  bool can_kick(shard_type& sh) const;
+  int kicks_limit(const shard_type& sh) const;
 
   void inc_run_count(void) { boost::mutex::scoped_lock lock(_run_mutex);  ++_run_count; }
   int dec_run_count(void) 
@@ -667,18 +1093,18 @@ private:
 
   //////////////////////////////////////////////////////////////////////////
   // processor
-  void process(void);
-  void kick_handler(void);
+  void process(size_t index);
+  void kick_handler(size_t index);
 
 private:
   void actually_stop(const boost::posix_time::time_duration& wait);
   void actually_disconnect_client(commid_type id);
 
 private:
-  typedef boost::shared_ptr<boost::asio::io_service> io_service_ptr_type;
   typedef smart::sync_queue<commid_type> disconnect_one_queue_type;
-  typedef boost::scoped_ptr<boost::asio::io_service::work> service_work_ptr_type;
   typedef boost::scoped_ptr<boost::asio::deadline_timer> timer_ptr_type;
+  typedef boost::scoped_ptr<boost::asio::steady_timer> steady_timer_ptr_type;
+  typedef boost::scoped_ptr<comm_pool> comm_pool_ptr_type;
 
 private:
   // mutex to synchronize an access to resources as handlers and client collection
@@ -688,9 +1114,12 @@ private:
   //mutable boost::mutex _run_count_mutex;
   boost::condition_variable _run_cond_var;
   //boost::condition_variable_any _run_cond_var;
+  // io services, each one serves own clients collection
+  shards_type _shards;
+  boost::atomic<size_t> _next_shard;
+  // threads calling run() are assigned to the io services under it
+  boost::mutex _run_shard_mutex;
   // listening stuff
-  io_service_ptr_type _ioservice;
-  service_work_ptr_type _service_work;
   boost::asio::ip::tcp::endpoint _endpoint;
 
   // fork support
@@ -712,10 +1141,6 @@ private:
 #endif // UNICOMM_SSL
 
   after_all_processed_handler_type _after_all_processed_handler;
-  // clients collection
-  //comm_container _clients;
-  //mutable comm_collection_type _clients;
-  comm_container_type _clients;
   // to gracefully stops the server
   disconnect_one_queue_type _disc_one_queue;
   const unicomm::config _config; 
@@ -726,8 +1151,16 @@ private:
   //volatile size_t _run_count;
   boost::atomic_int _run_count;
   timer_ptr_type _timer;
-  //mutable volatile int _kick_count;
-  mutable boost::atomic_int _kick_count;
+  // moves the message timeouts wheel on, 
+  // runs on the monotonic clock, so system time changes don't affect it
+  steady_timer_ptr_type _wheel_timer;
+  // the wheel timer is waited on, only the one setting it touches the timer
+  boost::atomic<bool> _wheel_armed;
+  // shared by all the communicators
+  timer_wheel _message_timeouts;
+  // idle communicators are bound to the io services, 
+  // so the pool lives no longer than they do
+  comm_pool_ptr_type _comm_pool;
 };
 
 /** Sends given message to the specified client. 
@@ -312,6 +312,25 @@ public:
     std::runtime_error(what) { /* empty */ }
 };
 
+/** Incoming message exceeds the length limit. 
+ *
+ *  The connection the message is received from is closed.
+ *
+ *  @see unicomm::config::max_message_length().
+ */
+class message_too_long_error : public message_decoder_error
+{
+//////////////////////////////////////////////////////////////////////////
+// interface
+public:
+  /** Constructs an object.
+   *
+   *  @param what Error description.
+   */
+  explicit message_too_long_error(const std::string& what): 
+    message_decoder_error(what) { /* empty */ }
+};
+
 /** Disallowed reply received error. 
  *
  *  Thrown by unicomm if received reply is not allowed by the configuration.  
@@ -331,6 +350,25 @@ public:
     std::runtime_error(what) { /* empty */ }
 };
 
+/** Outgoing stream error. 
+ *
+ *  Thrown if the data of the stream can't be produced.
+ *
+ *  @see unicomm::message_stream, unicomm::file_stream.
+ */
+class message_stream_error : public std::runtime_error
+{
+//////////////////////////////////////////////////////////////////////////
+// interface
+public:
+  /** Constructs an object.
+   *
+   *  @param what Error description.
+   */
+  explicit message_stream_error(const std::string& what): 
+    std::runtime_error(what) { /* empty */ }
+};
+
 /** Invalid session factory error. 
  *
  *  If session factory method is not properly setup this exception is thrown.
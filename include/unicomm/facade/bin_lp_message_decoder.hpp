@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// bin_lp_message_decoder.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Unified Communication protocol length prefixed binary message decoder.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_BIN_LP_MESSAGE_DECODER_HPP_
+#define UNI_BIN_LP_MESSAGE_DECODER_HPP_
+
+/** @file bin_lp_message_decoder.hpp Length prefixed binary message decoder. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/facade/bin_message_decoder.hpp>
+
+#include <cstddef>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+// forward
+class session_base;
+
+/** Unicomm length prefixed binary message decoder class. 
+ *
+ *  Message bounds are taken from the 32-bit length header, 
+ *  so finding a message costs the same regardless of its length.
+ *  Messages use the same header as unicomm::bin_message_decoder.
+ *
+ *  @see unicomm::bin_lp_message_encoder, unicomm::config::max_message_length().
+ */
+class bin_lp_message_decoder : public bin_message_decoder
+{
+//////////////////////////////////////////////////////////////////////////
+// interface
+public:
+  /** Creates a decoder. 
+   *
+   *  @param max_length Maximum message length, the length header 
+   *    is not counted. 0 (zero) means no limit.
+   */
+  explicit bin_lp_message_decoder(size_t max_length = 0): 
+    _max_length(max_length) 
+  { 
+    // empty
+  }
+
+public:
+  /** Whether the decoder limits the message length. 
+   *
+   *  @return True if the limit is set.
+   */
+  virtual bool limits_message_length(void) const { return _max_length != 0; }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  /** Finds message bounds using the length header. 
+   *
+   *  @param buffer Income raw data buffer.
+   *  @param session User session object representing the connection.
+   *  @return Pair of iterators where first is the begin of the message data
+   *    following the header and second is the end of the message.
+   *  @throw unicomm::message_too_long_error if the message length 
+   *    exceeds the limit.
+   */
+  virtual iter_pair_type find_raw_message(const comm_buffer::view_type& buffer,  
+    session_base& session);
+
+  /** Nothing is scanned, length header is only examined. 
+   *
+   *  @return 0 (zero).
+   */
+  virtual size_t scanned_length(const comm_buffer::view_type& /*buffer*/, 
+    session_base& /*session*/) { return 0; }
+
+  /** Message data is not escaped, nothing to decode. 
+   *
+   *  @param raw_message Message raw data.
+   *  @param session User session object representing the connection.
+   *  @return raw_message.
+   */
+  virtual std::string& decode_raw_message(std::string& raw_message, 
+    session_base& /*session*/) { return raw_message; }
+
+private:
+  size_t _max_length;
+};
+
+/** Creates length prefixed binary message decoder. 
+ *
+ *  @param max_length Maximum message length, the length header 
+ *    is not counted. 0 (zero) means no limit.
+ *
+ *  @return Smart pointer to newly created unicomm::message_decoder_base.
+ */
+inline message_decoder_base::pointer_type 
+  create_binary_lp_decoder(size_t max_length = 0)
+{
+  return message_decoder_base::pointer_type(new bin_lp_message_decoder(max_length));
+}
+
+} // namespace unicomm
+
+#endif // UNI_BIN_LP_MESSAGE_DECODER_HPP_
+
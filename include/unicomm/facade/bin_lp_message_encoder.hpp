@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// bin_lp_message_encoder.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Unified Communication protocol length prefixed binary message encoder.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_BIN_LP_MESSAGE_ENCODER_HPP_
+#define UNI_BIN_LP_MESSAGE_ENCODER_HPP_
+
+/** @file bin_lp_message_encoder.hpp Length prefixed binary message encoder. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/message_encoder_base.hpp>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+// forward
+class session_base;
+
+/** Unicomm length prefixed binary message encoder class. 
+ *
+ *  Sends the serialized message after its 32-bit length in network 
+ *  byte order. Message data is sent as is, there is no escaping and no 
+ *  end marker, so the message data doesn't need to be examined. 
+ *  The header is written from a buffer of its own, so the data is 
+ *  neither copied nor moved.
+ *
+ *  @see unicomm::message_encoder_base, unicomm::bin_lp_message_decoder.
+ */
+class bin_lp_message_encoder : public message_encoder_base
+{
+//////////////////////////////////////////////////////////////////////////
+// interface
+public:
+  /** Writes the length of the data. 
+   *
+   *  @param buffer Serialized message data.
+   *  @param header Storage the header is written to.
+   *  @param session User session object representing the connection.
+   *  @return Header length.
+   *  @throw std::length_error if the message is longer than 
+   *    32-bit length allows.
+   */
+  virtual size_t encode_frame_header(const out_buffer_type& buffer, 
+    char* header, session_base& session);
+};
+
+/** Creates length prefixed binary message encoder object. 
+ *
+ *  @return Smart pointer to newly created unicomm::message_encoder_base.
+ */
+inline message_encoder_base::pointer_type create_binary_lp_encoder(void)
+{
+  return message_encoder_base::pointer_type(new bin_lp_message_encoder());
+}
+
+} // namespace unicomm
+
+#endif // UNI_BIN_LP_MESSAGE_ENCODER_HPP_
+
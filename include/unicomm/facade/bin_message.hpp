@@ -122,6 +122,17 @@ public:
    */
   size_t priority(void) const;
 
+  /** Restores the state the message has been created with. 
+   *
+   *  Identifiers are cleared and the priority passed to the constructor 
+   *  is restored. Derived messages declaring reset support should 
+   *  call it from their own reset().
+   *
+   *  @see unicomm::message_base::reset(), 
+   *    unicomm::message_base::resettable().
+   */
+  void reset(void);
+
 //////////////////////////////////////////////////////////////////////////
 // private stuff
 private:
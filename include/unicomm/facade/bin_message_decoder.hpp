@@ -24,6 +24,8 @@
 #include <unicomm/config/auto_link.hpp>
 #include <unicomm/message_decoder_base.hpp>
 
+#include <string>
+
 /** @namespace unicomm Unicomm library root namespace. */
 namespace unicomm
 {
@@ -49,7 +51,16 @@ private:
    *  @return Pair of iterators where first is the begin of the message and 
    *    second is the end (designates to past the last element) of the message.
    */
-  virtual iter_pair_type find_raw_message(comm_buffer::buffer_type& buffer, 
+  virtual iter_pair_type find_raw_message(const comm_buffer::view_type& buffer,  
+    session_base& session);
+
+  /** Returns the length of the examined data containing no message end. 
+   *
+   *  @param buffer Income raw data buffer.
+   *  @param session User session object representing the connection.
+   *  @return Length of the buffer's head to be skipped by the next search.
+   */
+  virtual size_t scanned_length(const comm_buffer::view_type& buffer, 
     session_base& session);
 
   /** Should perform any decode operations if there are.
@@ -71,8 +82,31 @@ private:
    */
   virtual std::string get_message_name(const std::string& raw_message, 
     session_base& session);
+
+  /** Returns message type identifier extracted from raw data. 
+   *  
+   *  The name is looked up right in the raw data, it's not copied.
+   *
+   *  @param raw_message Message raw data.
+   *  @param session User session object representing the connection.
+   *  @return Message type identifier or unicomm::undefined_message_typeid() 
+   *    if the factory has no creator for the message.
+   *
+   *  @throw unicomm::message_decoder_error if an error is encountered while parsing.
+   */
+  virtual message_typeid_type get_message_type(const std::string& raw_message, 
+    session_base& session);
 };
 
+/** Restores the data escaped by unicomm::binary_encode() in place. 
+ *
+ *  @param s Data to be unescaped.
+ *  @return Reference to s.
+ *  @throw unicomm::message_decoder_error if the data ends with 
+ *    the escape symbol.
+ */
+UNICOMM_DECL std::string& binary_decode(std::string& s);
+
 /** Creates binary message decoder. 
  *
  *  @return Smart pointer to newly created unicomm::message_decoder_base.
@@ -23,6 +23,8 @@
 #include <unicomm/config/auto_link.hpp>
 #include <unicomm/message_encoder_base.hpp>
 
+#include <string>
+
 /** @namespace unicomm Unicomm library root namespace. */
 namespace unicomm
 {
@@ -51,6 +53,19 @@ private:
     session_base& session);
 };
 
+/** Escapes the binary message end and escape symbols in place. 
+ *
+ *  Every special symbol is replaced by the escape symbol followed by 
+ *  the symbol modified, so the data never contains the message end marker. 
+ *  The data is copied only if there is something to escape.
+ *
+ *  @param s Data to be escaped.
+ *  @return Reference to s.
+ *
+ *  @see unicomm::binary_decode().
+ */
+UNICOMM_DECL std::string& binary_encode(std::string& s);
+
 /** Creates binary message encoder object. 
  *
  *  @return Smart pointer to newly created unicomm::message_encoder_base.
@@ -52,7 +52,16 @@ private:
    *  @return Pair of iterators where first is the begin of the message and 
    *    second is the end of the message.
    */
-  virtual iter_pair_type find_raw_message(comm_buffer::buffer_type& buffer, 
+  virtual iter_pair_type find_raw_message(const comm_buffer::view_type& buffer,  
+    session_base& session);
+
+  /** Returns the length of the examined data containing no message end. 
+   *
+   *  @param buffer Income raw data buffer.
+   *  @param session User session object representing the connection.
+   *  @return Length of the buffer's head to be skipped by the next search.
+   */
+  virtual size_t scanned_length(const comm_buffer::view_type& buffer, 
     session_base& session);
 
   /** Should perform any decode operations if there are.
@@ -26,6 +26,7 @@
 #include <smart/factory.hpp>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
 
 #include <string>
 
@@ -67,9 +68,31 @@ public:
     { static const std::string s = "custom"; return s; }
 
 public:
+  /** Creates an object. */
+  message_base(void): _type_id(undefined_message_typeid()) { /* empty */ }
+
+  /** Creates a copy of the object. 
+   *
+   *  Message type identifier is not copied, the copy may be of the other 
+   *  type (sliced one), so the identifier is resolved again when necessary.
+   */
+  message_base(const message_base& /*other*/): 
+    _type_id(undefined_message_typeid()) 
+  { 
+    /* empty */ 
+  }
+
   /** Destroys an object. */
   virtual ~message_base(void) { /* empty */ }
 
+  /** Assigns the object. 
+   *
+   *  Message type identifier is kept, the type of the object doesn't change.
+   *
+   *  @return *this.
+   */
+  message_base& operator=(const message_base& /*other*/) { return *this; }
+
 public:
   /** Returns message instance identifier. 
    *
@@ -182,6 +205,69 @@ public:
    *    unicomm::undefined_priority().
    */
   virtual size_t priority(void) const { return undefined_priority(); }
+
+  /** Restores the state the message has been created with. 
+   *
+   *  Called before a pooled message object is reused for the next 
+   *  received message. Override to clear the data 
+   *  unicomm::message_base::unserialize() doesn't overwrite, e.g. 
+   *  optional fields and containers it appends to. 
+   *  Default implementation does nothing.
+   *
+   *  @note Shouldn't throw.
+   *  @see unicomm::message_base::resettable(), 
+   *    unicomm::config::message_pool_size().
+   */
+  virtual void reset(void) { /* empty */ }
+
+  /** Whether the message object may be reused for another message. 
+   *
+   *  Only the messages returning true are pooled, the others are 
+   *  created for every received message even if pooling is on. 
+   *  Override to return true if unicomm::message_base::reset() 
+   *  restores the whole state of the message. 
+   *  Default implementation returns false.
+   *
+   *  @return True if the message supports reset.
+   *  @see unicomm::config::message_pool_size().
+   */
+  virtual bool resettable(void) const { return false; }
+
+public:
+  /** Returns message type identifier. 
+   *
+   *  Message type identifier is the interned message_base::name(). 
+   *  It's resolved by the engine when the message is looked up by the 
+   *  configuration the first time, so the following lookups of the 
+   *  message policies don't involve the name.
+   *
+   *  @return Message type identifier or unicomm::undefined_message_typeid() 
+   *    if it's not resolved yet.
+   *
+   *  @see unicomm::config::message_type(), unicomm::register_message_type().
+   */
+  message_typeid_type type_id(void) const 
+    { return _type_id.load(boost::memory_order_relaxed); }
+
+  /** Sets message type identifier. 
+   *
+   *  The identifier caches the interned message_base::name(), so it's 
+   *  allowed to be set for a const message. 
+   *
+   *  @param type Message type identifier, should be the one 
+   *    unicomm::register_message_type() returns for message_base::name().
+   *
+   *  @return *this.
+   *  @see unicomm::config::message_type(), unicomm::register_message_type().
+   */
+  const message_base& type_id(message_typeid_type type) const 
+    { _type_id.store(type, boost::memory_order_relaxed); return *this; }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  // the message may be sent by several threads at once
+  mutable boost::atomic<message_typeid_type> _type_id;
 };
 
 /** Reads predefined id property. 
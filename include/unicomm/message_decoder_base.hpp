@@ -24,11 +24,13 @@
 #include <unicomm/config/auto_link.hpp>
 #include <unicomm/comm_buffer.hpp>
 #include <unicomm/message_base.hpp>
+#include <unicomm/message_pool.hpp>
 #include <unicomm/basic.hpp>
 
 #include <boost/shared_ptr.hpp>
 
 #include <string>
+#include <vector>
 #include <utility>
 
 /** @namespace unicomm Unicomm library root namespace. */
@@ -55,15 +57,22 @@ public:
   typedef boost::shared_ptr<message_decoder_base> pointer_type;
 
 public:
+  /** Creates an instance of the class. */
+  message_decoder_base(void): _message_pool_size(0) { /* empty */ }
+
   /** Destroys an instance of the class. */
   virtual ~message_decoder_base(void) { /* empty */ }
 
 public:
   /** Sets factory object used to create message.  
+   *
+   *  Names of the messages the factory creates are interned, so 
+   *  the creators are looked up by the message type identifier.
    *
    *  @param factory Message factory object.
+   *  @see unicomm::register_message_type().
    */
-  void factory(const message_base::factory_type& factory) { _factory = factory; }
+  void factory(const message_base::factory_type& factory);
 
   /** Returns factory object. 
    *
@@ -71,6 +80,25 @@ public:
    */
   const message_base::factory_type& factory(void) const { return _factory; }
 
+  /** Sets maximum number of idle message objects kept for reuse per type. 
+   *
+   *  @param n Idle messages limit, 0 (zero) disables pooling.
+   *  @see unicomm::config::message_pool_size().
+   */
+  void message_pool_size(size_t n);
+
+  /** Returns maximum number of idle message objects kept for reuse per type. 
+   *
+   *  @return Idle messages limit.
+   */
+  size_t message_pool_size(void) const { return _message_pool_size; }
+
+  /** Returns the pool of the created messages. 
+   *
+   *  @return Messages pool or null pointer if pooling is disabled.
+   */
+  const message_pool* pool(void) const { return _pool.get(); }
+
 public:
   /** Algorithm implementation. 
    *
@@ -90,19 +118,44 @@ public:
   virtual message_base::pointer_type perform_decode(comm_buffer& buffer, 
     session_base& session);
 
+  /** Whether the decoder limits the incoming message length by itself. 
+   *
+   *  If it does, the communicator doesn't check the length of the 
+   *  buffered data against unicomm::config::max_message_length(), 
+   *  the data may contain the framing the decoder doesn't count.
+   *
+   *  @return Default implementation returns false.
+   */
+  virtual bool limits_message_length(void) const { return false; }
+
 //////////////////////////////////////////////////////////////////////////
 // protected stuff
 protected:
   /** Pair of income buffer iterators. */
-  typedef std::pair<comm_buffer::buffer_type::iterator, 
-    comm_buffer::buffer_type::iterator> iter_pair_type;
+  typedef std::pair<comm_buffer::view_type::const_iterator, 
+    comm_buffer::view_type::const_iterator> iter_pair_type;
+
+protected:
+  /** Looks up the type of the message the factory creates. 
+   *
+   *  Doesn't allocate memory, so the decoders are able to find 
+   *  the message type by the name right in the raw data.
+   *
+   *  @param first Pointer to the first symbol of the message name.
+   *  @param last Pointer past the last symbol of the message name.
+   *  @return Message type identifier or unicomm::undefined_message_typeid() 
+   *    if there is no creator registered for the name.
+   */
+  message_typeid_type find_factory_type(const char* first, 
+    const char* last) const;
 
 //////////////////////////////////////////////////////////////////////////
 // private stuff
 private:
   /** Finds message's bounds. 
    *
-   *  @param buffer Raw data arrived from channel.
+   *  @param buffer View of the raw data arrived from channel and 
+   *    not consumed yet.
    *  @param session User session object representing the connection.
    *  @return Pair of iterators that designates to the begin and the end of the 
    *    decoded message data. 
@@ -110,17 +163,40 @@ private:
    *  @note If there is no message found both iterators should
    *    have the same value, e.g. points to the buffer.end().
    *
+   *  @note Everything up to the end of the message is consumed 
+   *    from the buffer, including the data preceding the message.
+   *
+   *  @note The search may start at buffer.scanned(), the data before 
+   *    is already examined by the previous calls and contains no message.
+   *
    *  @note May throw any derived from std::exception if error occurs. 
    *    Not std::exception throwing causes debug will assert.
    */
-  virtual iter_pair_type find_raw_message(comm_buffer::buffer_type& /*buffer*/, 
+  virtual iter_pair_type find_raw_message(const comm_buffer::view_type& /*buffer*/, 
                                           session_base& /*session*/) // = 0;
   { 
     return std::make_pair(iter_pair_type::first_type(), 
       iter_pair_type::second_type()); 
   } 
 
-  /** Decode message data. 
+  /** Returns the length of the buffer's head that is known to contain no message. 
+   *
+   *  Called if unicomm::message_decoder_base::find_raw_message() has found 
+   *  nothing. The returned value is passed back through buffer.scanned() 
+   *  on the next call for the same connection, so the data is not scanned 
+   *  again as more of it arrives. Take into account the end of message 
+   *  marker may be split between the examined data and the data to come.
+   *
+   *  @param buffer View of the raw data that has just been examined.
+   *  @param session User session object representing the connection.
+   *  @return Length of the examined head of the buffer. Default 
+   *    implementation returns 0 (zero), so the buffer is scanned 
+   *    from the beginning every time.
+   */
+  virtual size_t scanned_length(const comm_buffer::view_type& /*buffer*/, 
+    session_base& /*session*/) { return 0; }
+
+  /** Decode message data.  
    *
    *  This is used to decode message. Remove markers and dereference 
    *  escape symbols for example in case of binary encoding.
@@ -152,6 +228,28 @@ private:
   virtual std::string get_message_name(const std::string& /*raw_message*/, 
     session_base& /*session*/) { return std::string(); } // = 0;
 
+  /** Returns message type identifier extracted from incoming raw data. 
+   *
+   *  Default implementation looks up the name returned by 
+   *  unicomm::message_decoder_base::get_message_name(). Override this 
+   *  to avoid the name copy, e.g. using 
+   *  unicomm::message_decoder_base::find_factory_type().
+   *
+   *  @param raw_message Incoming decoded raw data. 
+   *    This is returned result from 
+   *    unicomm::message_decoder_base::decode_raw_message().
+   * 
+   *  @param session User session object representing the connection.
+   *  @return Message type identifier or unicomm::undefined_message_typeid() 
+   *    if the factory has no creator for the message. In the last case 
+   *    the message is created by the name.
+   *
+   *  @note May throw the same as 
+   *    unicomm::message_decoder_base::get_message_name() does.
+   */
+  virtual message_typeid_type get_message_type(const std::string& raw_message, 
+    session_base& session);
+
   /** Creates a message using given name (identifier). 
    *
    *  By default, this creates user's message using factory 
@@ -171,6 +269,24 @@ private:
   virtual message_base::pointer_type create_message(const std::string& name, 
     session_base& session);
 
+  /** Creates a message of the given type. 
+   *
+   *  By default, this creates user's message using the creator the 
+   *  factory has for the type or takes the message from the pool 
+   *  if pooling is enabled. Used instead of  
+   *  unicomm::message_decoder_base::create_message() taking the name 
+   *  if the message type is found.
+   *
+   *  @param type Type identifier of the message to be created.
+   *  @param session User session object representing the connection.
+   *  @note May throw any derived from std::exception if error occurs. 
+   *    Not std::exception throwing causes debug will assert.
+   *
+   *  @see unicomm::message_decoder_base::get_message_type().
+   */
+  virtual message_base::pointer_type create_message(message_typeid_type type, 
+    session_base& session);
+
 //////////////////////////////////////////////////////////////////////////
 // private stuff
 private:
@@ -178,6 +294,24 @@ private:
   // client & server provides const interface to the configuration and it 
   // can't be changed once created
   message_base::factory_type _factory;
+
+  // creators indexed by the message type identifier
+  struct type_creator
+  {
+    message_base::factory_type::creator_type creator;
+    std::string name;
+  };
+
+  typedef std::vector<type_creator> type_creators_type;
+  typedef std::vector<std::pair<std::string, message_typeid_type> > 
+    factory_types_type;
+
+  type_creators_type _type_creators;
+  // sorted by the name
+  factory_types_type _factory_types;
+
+  size_t _message_pool_size;
+  boost::shared_ptr<message_pool> _pool;
 };
 
 } // namespace unicomm
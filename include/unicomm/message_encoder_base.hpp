@@ -49,6 +49,9 @@ public:
   /** Message encoder base smart pointer type. */
   typedef boost::shared_ptr<message_encoder_base> pointer_type;
 
+  /** Maximum frame header length in bytes. */
+  static const size_t max_frame_header_len = 8;
+
 public:
   /** Destroys an object. */
    virtual ~message_encoder_base(void) { /* empty */ }
@@ -59,11 +62,40 @@ public:
    *  @param message Message to be encoded (serialized).
    *  @param session User session object representing the connection.
    *  @return Raw buffer contained encoded message to be 
-   *    written to the channel.
+   *    written to the channel. The frame header, if any, is not included.
+   *  @see unicomm::message_encoder_base::encode_frame_header().
    */
   virtual const out_buffer_type perform_encode(const message_base& message, 
     session_base& session);
 
+  /** Whether encoded data depends on the session. 
+   *
+   *  A message broadcast by unicomm::dispatcher::send_all() is encoded 
+   *  once and the same buffer is written to every connection unless 
+   *  the encoder depends on the session. Encoders making use of 
+   *  the session object should return true.
+   *
+   *  @return Default implementation returns false.
+   */
+  virtual bool session_dependent(void) const { return false; }
+
+  /** Writes the frame header sent ahead of the encoded message. 
+   *
+   *  The header is written to the socket by the same gather write as 
+   *  the encoded data, but from a buffer of its own, so framing doesn't 
+   *  move the data. It's called for every connection the message is 
+   *  sent to, even if the encoded data is shared.
+   *
+   *  @param buffer Encoded message data returned by perform_encode().
+   *  @param header Storage of unicomm::message_encoder_base::max_frame_header_len 
+   *    bytes the header is written to.
+   *  @param session User session object representing the connection.
+   *  @return Header length. Default implementation returns 0 (zero), 
+   *    there is no header.
+   */
+  virtual size_t encode_frame_header(const out_buffer_type& /*buffer*/, 
+    char* /*header*/, session_base& /*session*/) { return 0; }
+
 //////////////////////////////////////////////////////////////////////////
 // private stuff
 private:
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+// message_pool.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Pool of the message objects created by the decoder.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_MESSAGE_POOL_HPP_
+#define UNI_MESSAGE_POOL_HPP_
+
+/** @file message_pool.hpp Pool of the received message objects. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/message_base.hpp>
+#include <unicomm/basic.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** Pool of the message objects the decoder creates.
+ *
+ *  Each message type has a list of idle objects of its own. A message
+ *  handed out by the pool returns there as soon as the last reference
+ *  to it is released, i.e. usually when the message arrived handler
+ *  returns. The object is reset by unicomm::message_base::reset()
+ *  before it's reused, so only the messages declaring reset support
+ *  by unicomm::message_base::resettable() are pooled. The number of idle objects held per type
+ *  is limited, objects released over the limit are freed.
+ *
+ *  @note The interface is thread safe.
+ *
+ *  @see unicomm::config::message_pool_size().
+ */
+class UNICOMM_DECL message_pool : private boost::noncopyable
+{
+public:
+  /** Message creator type. */
+  typedef message_base::factory_type::creator_type creator_type;
+
+public:
+  /** Creates a pool.
+   *
+   *  @param types Count of the message types served, types are
+   *    identified by 0 (zero) based unicomm::message_typeid_type.
+   *    Messages of the other types are created, but not pooled.
+   *
+   *  @param max_idle Maximum idle objects count held per type.
+   */
+  message_pool(size_t types, size_t max_idle);
+
+public:
+  /** Returns a message object of the given type.
+   *
+   *  Takes an idle object if any or creates a new one otherwise. 
+   *  The messages not supporting reset are never pooled.
+   *
+   *  @param type Message type identifier.
+   *  @param creator Creates the message if there is no idle one.
+   *  @return Message object.
+   */
+  message_base::pointer_type acquire(message_typeid_type type,
+    const creator_type& creator);
+
+  /** Returns maximum idle objects count held per type.
+   *
+   *  @return Idle objects limit.
+   */
+  size_t max_idle(void) const { return _max_idle; }
+
+  /** Returns the count of idle objects of the type.
+   *
+   *  @param type Message type identifier.
+   *  @return Idle objects count.
+   */
+  size_t idle_count(message_typeid_type type) const;
+
+  /** How many times an idle object of the type has been reused.
+   *
+   *  @param type Message type identifier.
+   *  @return Pool hits count.
+   */
+  size_t hits(message_typeid_type type) const;
+
+  /** How many objects of the type have been created.
+   *
+   *  @param type Message type identifier.
+   *  @return Pool misses count.
+   */
+  size_t misses(message_typeid_type type) const;
+
+  /** How many times an idle object of any type has been reused.
+   *
+   *  @return Pool hits count.
+   */
+  size_t hits(void) const;
+
+  /** How many objects of any type have been created.
+   *
+   *  @return Pool misses count.
+   */
+  size_t misses(void) const;
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  class type_pool;
+
+  typedef boost::shared_ptr<type_pool> type_pool_ptr;
+  typedef std::vector<type_pool_ptr> type_pools_type;
+
+private:
+  // pools are shared with the messages handed out,
+  // so the messages are able to outlive this object
+  type_pools_type _pools;
+  const size_t _max_idle;
+};
+
+} // namespace unicomm
+
+#endif // UNI_MESSAGE_POOL_HPP_
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// message_stream.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Outgoing data produced by chunks.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_MESSAGE_STREAM_HPP_
+#define UNI_MESSAGE_STREAM_HPP_
+
+/** @file message_stream.hpp Outgoing data produced by chunks. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/basic.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+
+#include <string>
+#include <fstream>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** Outgoing data which is produced on demand.
+ *
+ *  Used to send the data which is too large to be held in memory at once,
+ *  e.g. a file. The communicator asks the stream for the next chunk
+ *  each time the previous one is written, so only one chunk per
+ *  connection is held in memory. Like the data sent by
+ *  unicomm::communicator::send_raw() the chunks are written as is,
+ *  they aren't encoded.
+ *
+ *  @note The stream is only accessed by the communicator it's sent by,
+ *    and never concurrently.
+ *
+ *  @see unicomm::communicator::send_stream(), unicomm::config::stream_chunk_size().
+ */
+class UNICOMM_DECL message_stream : private boost::noncopyable
+{
+public:
+  /** Stream pointer type. */
+  typedef boost::shared_ptr<message_stream> pointer_type;
+
+public:
+  /** Destroys the stream. */
+  virtual ~message_stream(void) { /* empty */ }
+
+public:
+  /** Produces the next chunk of the data.
+   *
+   *  @param chunk Buffer to put the data to, it's empty on call.
+   *  @param max_size Chunk size limit. Producing less data is allowed,
+   *    but producing nothing means there is no more data.
+   *
+   *  @throw Any exception derived from std::exception stops the stream,
+   *    the rest of the data isn't sent. It's passed to the error handler
+   *    the same way as the exceptions thrown by serialize().
+   */
+  virtual void read_chunk(out_buffer_type& chunk, size_t max_size) = 0;
+
+  /** Whether all the data is produced.
+   *
+   *  @return true if there are no more chunks.
+   */
+  virtual bool eof(void) const = 0;
+
+  /** Whether other messages may be written between the chunks.
+   *
+   *  If every chunk is a complete frame of the protocol, queued messages
+   *  of higher priority are written between the chunks and the stream
+   *  goes on with its priority. Otherwise the chunks are written one
+   *  after another, the other messages wait for the stream to end.
+   *
+   *  @return Default implementation returns false.
+   */
+  virtual bool self_delimited(void) const { return false; }
+};
+
+/** Streams a range of the file.
+ *
+ *  The file is opened by the constructor and is read a chunk at a time
+ *  while the data is being sent.
+ */
+class UNICOMM_DECL file_stream : public message_stream
+{
+public:
+  /** Opens a file.
+   *
+   *  @param file_name File to be sent.
+   *  @param offset Offset to start from.
+   *  @param length Bytes count to be sent, if it exceeds the file size
+   *    the data up to the end of the file is sent.
+   *
+   *  @throw unicomm::message_stream_error if the file can't be opened
+   *    or positioned.
+   */
+  explicit file_stream(const std::string& file_name, boost::uintmax_t offset = 0,
+    boost::uintmax_t length = boost::uintmax_t(-1));
+
+public:
+  /** Reads the next chunk of the file.
+   *
+   *  @throw unicomm::message_stream_error on read failure.
+   */
+  /*virtual*/ void read_chunk(out_buffer_type& chunk, size_t max_size);
+
+  /** Whether the range is read. */
+  /*virtual*/ bool eof(void) const { return _left == 0; }
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  std::ifstream _file;
+  std::string _file_name;
+  boost::uintmax_t _left;
+};
+
+} // namespace unicomm
+
+#endif // UNI_MESSAGE_STREAM_HPP_
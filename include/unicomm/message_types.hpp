@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// message_types.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Message types registry.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_MESSAGE_TYPES_HPP_
+#define UNI_MESSAGE_TYPES_HPP_
+
+/** @file message_types.hpp Message types registry. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/basic.hpp>
+
+#include <string>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** Registers message type name.
+ *
+ *  Message names are interned by the process wide registry. Each name gets
+ *  a small integer identifier, identifiers are dense and never change,
+ *  so they are used to index message type related tables instead of names.
+ *  Registering the name already registered returns the same identifier.
+ *
+ *  @param name Message name.
+ *  @return Message type identifier.
+ *
+ *  @note Thread safe.
+ *  @see unicomm::message_base::name(), unicomm::config::message_type().
+ */
+UNICOMM_DECL message_typeid_type register_message_type(const std::string& name);
+
+/** Looks up message type identifier.
+ *
+ *  @param name Message name.
+ *  @return Message type identifier or unicomm::undefined_message_typeid()
+ *    if the name is not registered.
+ *
+ *  @note Thread safe.
+ */
+UNICOMM_DECL message_typeid_type find_message_type(const std::string& name);
+
+/** Returns the name of the message type.
+ *
+ *  @param type Message type identifier.
+ *  @return Message name or empty string if the type is not registered.
+ *
+ *  @note Thread safe.
+ */
+UNICOMM_DECL const std::string& message_type_name(message_typeid_type type);
+
+} // namespace unicomm
+
+#endif // UNI_MESSAGE_TYPES_HPP_
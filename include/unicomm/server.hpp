@@ -26,6 +26,11 @@
 
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
 
 /** @namespace unicomm Unicomm library root namespace. */
 namespace unicomm
@@ -41,9 +46,15 @@ class UNICOMM_DECL server : public dispatcher
 {
 //////////////////////////////////////////////////////////////////////////
 // interface
+public:
+  /** Listening endpoints collection type. */
+  typedef unicomm::config::endpoints_type endpoints_type;
+
 public:
   /** Constructs server object.
    *
+   *  Listens to unicomm::config::listen_endpoints() if there are any 
+   *  and to unicomm::config::endpoint() otherwise.
    *  By default listen address is any.
    *  
    *  @param config Server configuration object.
@@ -63,6 +74,19 @@ public:
   server(const unicomm::config& config, 
     const boost::asio::ip::tcp::endpoint &listen_endpoint);
 
+  /** Constructs server object listening to several endpoints.
+   *  
+   *  @param config Server object configuration. 
+   *  @param listen_endpoints Ip-addresses and ports to be listened to.
+   *    IPv4 and IPv6 endpoints can be mixed. Overrides configuration values.
+   *
+   *  @note The copy of config is held.
+   *  @see unicomm::config::listen_endpoints(), 
+   *    unicomm::config::server_ipv6_only().
+   */
+  server(const unicomm::config& config, 
+    const endpoints_type &listen_endpoints);
+
   /** Stops dispatcher and destroys an object. */
   ~server(void);
 
@@ -70,14 +94,25 @@ public:
   // fixme: Call this from within connected (accepted) handler to 
   // continue accepting connections.
 
-  /** Tells the underlying logic to perform one accept operation on the socket. 
+  /** Tells the underlying logic to start accepting on the listening sockets. 
    *
    *  Should be called once to start accepting incoming connections.
-   * 
+   *  Every listening socket gets unicomm::config::server_pending_accepts() 
+   *  accept operations, each of them is started again as it completes.
+   *  A completed accept takes up to unicomm::config::server_accept_burst() 
+   *  connections from the backlog at once.
+   *  
    *  @see connected_signal_type, session_base::connected_handler().
    */
   void accept(void);
 
+  /** Returns the endpoints the server listens to.
+   *
+   *  @return Listening endpoints, there is at least one.
+   */
+  const endpoints_type& listen_endpoints(void) const 
+    { return _listen_endpoints; }
+
 //////////////////////////////////////////////////////////////////////////
 // protected stuff
 protected:
@@ -95,6 +130,8 @@ protected:
   /** @brief Returns a reference to the entity responsible for the 
    *    accepting incoming connections.
    *
+   *  If there are several listening sockets this is the first one.
+   *
    *  @return A reference to a tcp::acceptor.
    *  @note @b IMPORTANT! Should not be used in this revision.
    */ 
@@ -167,24 +204,36 @@ private:
   //////////////////////////////////////////////////////////////////////////
   // misc
   //bool is_acceptor(void) const;
-  void constructor(void);
+  void constructor(const endpoints_type& listen_endpoints);
   void initialize(void);
   void finalize(void);
   void just_start_accept(void);
+  void accept_one(size_t index);
+  void accept_into(size_t index, const comm_ptr& spare);
+  comm_ptr create_accepted_comm(size_t index);
+  comm_ptr take_backlog(size_t index, comm_sequence_type& clients);
+  void retry_accept(size_t index, const comm_ptr& spare);
+  void start_accepted(const comm_ptr& client);
   void create_listening_socket(void);
   void create_acceptor(void);
   void open_acceptor(void);
   void close_acceptor(void);
   void destroy_acceptor(void);
-  bool is_acceptor_opened(void) /*const*/ { return acceptor().is_open(); }
   //
   void call_after_accept(tcp_socket_type& socket);
 
+private:
+  // delays an accept failed for lack of resources, 
+  // runs on the monotonic clock, so system time changes don't affect it
+  typedef boost::shared_ptr<boost::asio::steady_timer> retry_timer_ptr_type;
+
 private:
   //////////////////////////////////////////////////////////////////////////
   // boost asio handlers
-  void asio_accept_handler(const comm_ptr& client, 
+  void asio_accept_handler(size_t index, const comm_ptr& client, 
     const boost::system::error_code& error);
+  void asio_retry_accept_handler(size_t index, const comm_ptr& spare, 
+    const retry_timer_ptr_type& timer, const boost::system::error_code& error);
 
 #ifdef UNICOMM_SSL
 
@@ -195,10 +244,43 @@ private:
 
 private:
   typedef boost::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor_ptr_type;
+  typedef boost::shared_ptr<boost::asio::io_service::strand> strand_ptr_type;
+
+  //////////////////////////////////////////////////////////////////////////
+  // listening socket and the io service it's served by
+  class listener
+  {
+  public:
+    listener(boost::asio::io_service& ioservice, size_t index, 
+      const boost::asio::ip::tcp::endpoint& ep):
+      _acceptor(new acceptor_ptr_type::element_type(ioservice)),
+      _strand(new strand_ptr_type::element_type(ioservice)),
+      _index(index),
+      _endpoint(ep)
+    {
+      // empty
+    }
+
+  public:
+    boost::asio::ip::tcp::acceptor& acceptor(void) const { return *_acceptor; }
+    boost::asio::io_service::strand& strand(void) const { return *_strand; }
+    size_t ioservice_index(void) const { return _index; }
+    const boost::asio::ip::tcp::endpoint& endpoint(void) const { return _endpoint; }
+
+  private:
+    acceptor_ptr_type _acceptor;
+    // the accepts pending on the socket are started and completed through it
+    strand_ptr_type _strand;
+    size_t _index;
+    boost::asio::ip::tcp::endpoint _endpoint;
+  };
+
+  typedef std::vector<listener> listeners_type;
 
 private:
   // listening stuff
-  acceptor_ptr_type _acceptor;
+  endpoints_type _listen_endpoints;
+  listeners_type _listeners;
 };
 
 } // namespace unicomm
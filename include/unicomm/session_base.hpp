@@ -72,6 +72,32 @@ public:
    */
   virtual bool is_server(void) const { return true; }
 
+  /** Whether the session object may serve the next connection. 
+   *
+   *  Asked when a pooled communicator is released. If true is returned 
+   *  the object stays with the communicator and is prepared for the next 
+   *  connection by unicomm::session_base::reset() instead of a new one 
+   *  being created by the session factory. Otherwise the object is 
+   *  released along with the connection.
+   *
+   *  @return By default always returns false.
+   *  @see unicomm::config::comm_pool_size().
+   */
+  virtual bool recyclable(void) const { return false; }
+
+  /** Prepares the recycled session object for the next connection. 
+   *
+   *  Called instead of the session factory before the connected handler 
+   *  is invoked. Should restore the state the object is constructed with.
+   *
+   *  @param params The same parameters the session factory gets.
+   *  @note Exceptions are treated the same way as the ones thrown 
+   *    by the session constructor.
+   *
+   *  @see unicomm::session_base::recyclable().
+   */
+  virtual void reset(const connected_params& /*params*/) { /* empty */ }
+
 public:
   /** Actually calls virtual message arrived handler. 
    *
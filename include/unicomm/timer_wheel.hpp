@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+// timer_wheel.hpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Hashed timing wheel serving message timeouts.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#ifdef _MSC_VER
+# pragma once
+#endif // _MSC_VER
+
+#ifndef UNI_TIMER_WHEEL_HPP_
+#define UNI_TIMER_WHEEL_HPP_
+
+/** @file timer_wheel.hpp Message timeouts timing wheel definition. */
+
+#include <unicomm/config/auto_link.hpp>
+#include <unicomm/basic.hpp>
+
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+/** @namespace unicomm Unicomm library root namespace. */
+namespace unicomm
+{
+
+/** Hashed timing wheel the message timeouts are scheduled by.
+ *
+ *  The wheel consists of the fixed number of slots, each one covers
+ *  a tick of timer_wheel::resolution() milliseconds. A timeout is put
+ *  into the slot it elapses at and counts the wheel rounds left,
+ *  so scheduling costs O(1) and a tick only looks at a single slot.
+ *
+ *  Timeouts are not removed from the wheel on cancellation. The owner
+ *  tells expired entries of cancelled timeouts by their serial numbers
+ *  and ignores them.
+ *
+ *  @note The interface is thread safe.
+ *
+ *  @see unicomm::config::timeouts_resolution().
+ */
+class UNICOMM_DECL timer_wheel : private boost::noncopyable
+{
+public:
+  /** Scheduled timeout. */
+  class entry
+  {
+  public:
+    /** Constructs an entry.
+     *
+     *  @param comm Communicator the timeout belongs to.
+     *  @param mid Message identifier.
+     *  @param serial Serial number of the timeout.
+     *  @param rounds Wheel rounds left before it elapses.
+     */
+    entry(const comm_pointer_type& comm, messageid_type mid,
+          size_t serial, size_t rounds):
+      _comm(comm), _mid(mid), _serial(serial), _rounds(rounds)
+    {
+      // empty
+    }
+
+  public:
+    /** Returns the communicator or null one if it's destroyed. */
+    comm_pointer_type comm(void) const { return _comm.lock(); }
+    /** Returns the message identifier. */
+    messageid_type mid(void) const { return _mid; }
+    /** Returns the serial number of the timeout. */
+    size_t serial(void) const { return _serial; }
+
+  private:
+    friend class timer_wheel;
+
+    boost::weak_ptr<communicator> _comm;
+    messageid_type _mid;
+    size_t _serial;
+    size_t _rounds;
+  };
+
+  /** Entries collection type. */
+  typedef std::vector<entry> entries_type;
+
+public:
+  /** Creates a wheel.
+   *
+   *  @param resolution Tick duration in milliseconds.
+   *  @param slots Slots count.
+   */
+  timer_wheel(size_t resolution, size_t slots);
+
+public:
+  /** Schedules a timeout.
+   *
+   *  The timeout never elapses earlier than requested and is detected
+   *  at most one tick later.
+   *
+   *  @param comm Communicator the timeout belongs to.
+   *  @param mid Message identifier.
+   *  @param serial Serial number to identify the timeout by on expiration.
+   *  @param tout Timeout in milliseconds.
+   */
+  void schedule(const comm_pointer_type& comm, messageid_type mid,
+    size_t serial, size_t tout);
+
+  /** Moves the wheel on by one tick.
+   *
+   *  @param expired Receives elapsed timeouts.
+   */
+  void advance(entries_type& expired);
+
+  /** Returns the tick duration.
+   *
+   *  @return Tick duration in milliseconds.
+   */
+  size_t resolution(void) const { return _resolution; }
+
+  /** Returns the number of scheduled timeouts.
+   *
+   *  @return Scheduled timeouts count including cancelled ones
+   *    which are not elapsed yet.
+   */
+  size_t size(void) const;
+
+//////////////////////////////////////////////////////////////////////////
+// private stuff
+private:
+  typedef std::vector<entries_type> slots_type;
+
+private:
+  mutable boost::mutex _mutex;
+  slots_type _slots;
+  size_t _current;
+  size_t _size;
+  const size_t _resolution;
+};
+
+} // namespace unicomm
+
+#endif // UNI_TIMER_WHEEL_HPP_
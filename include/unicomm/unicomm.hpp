@@ -32,6 +32,7 @@
 #include <unicomm/session_base.hpp>
 #include <unicomm/basic_session.hpp>
 #include <unicomm/helper.hpp>
+#include <unicomm/message_stream.hpp>
 #include <unicomm/basic.hpp>
 #include <unicomm/except.hpp>
 
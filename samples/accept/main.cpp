@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////
+// main.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Connection rate benchmark. Starts a server and a number of connecting
+// threads on the loopback, each of them connects and drops the connection
+// as fast as possible. Prints how many connections per second the server
+// has accepted.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/unicomm.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/asio.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (push)
+# pragma warning (disable : 4512)  // warning C4512: 'boost::program_options::options_description' : assignment operator could not be generated
+#endif // _MSC_VER
+
+#include <boost/program_options.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (pop)
+#endif // _MSC_VER
+
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+#include <cstdlib>
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using boost::asio::ip::tcp;
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
+using boost::posix_time::seconds;
+using boost::posix_time::milliseconds;
+
+namespace
+{
+
+namespace po = boost::program_options;
+
+boost::atomic<size_t> accepted(0);
+boost::atomic<size_t> connected(0);
+boost::atomic<size_t> failed(0);
+
+//////////////////////////////////////////////////////////////////////////
+// server session, only counts connections
+class accept_session : public unicomm::basic_session<accept_session>
+{
+public:
+  explicit accept_session(const unicomm::connected_params& /*params*/)
+    { /* empty */ }
+
+public:
+  // there is no state, so the object serves the connections to come
+  bool recyclable(void) const { return true; }
+
+protected:
+  void connected_handler(const unicomm::connected_params& /*params*/)
+    { ++accepted; }
+};
+
+//------------------------------------------------------------------------
+po::variables_map handle_command_line(int argc, char* argv[])
+{
+  po::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "Produce help message")
+    ("port,p", po::value<unsigned short>()->default_value(55556),
+      "Port to listen to on the loopback")
+    ("acceptors,a", po::value<size_t>()->default_value(1),
+      "Listening sockets count, bound with SO_REUSEPORT if more than one")
+    ("pending,n", po::value<size_t>()->default_value(1),
+      "Accepts pending on each listening socket")
+    ("burst,b", po::value<size_t>()->default_value(16),
+      "Connections taken from the backlog per completed accept")
+    ("comm-pool,m", po::value<size_t>()->default_value(0),
+      "Idle communicators kept for reuse per io service, 0 disables pooling")
+    ("io-services,i", po::value<size_t>()->default_value(1),
+      "Server io services count")
+    ("threads,t", po::value<size_t>()->default_value(1),
+      "Server threads count, at least one per io service is started")
+    ("connectors,c", po::value<size_t>()->default_value(4),
+      "Connecting threads count")
+    ("duration,d", po::value<size_t>()->default_value(5),
+      "Benchmark duration in seconds");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    cout << desc << endl;
+
+    exit(EXIT_SUCCESS);
+  }
+
+  return vm;
+}
+
+//------------------------------------------------------------------------
+void server_task(unicomm::dispatcher& d)
+{
+  d.run();
+}
+
+//------------------------------------------------------------------------
+void connector_task(const tcp::endpoint& ep, const ptime& deadline)
+{
+  boost::asio::io_service ioservice;
+
+  while (microsec_clock::universal_time() < deadline)
+  {
+    tcp::socket socket(ioservice);
+    boost::system::error_code error;
+
+    socket.connect(ep, error);
+    if (error)
+    {
+      ++failed;
+      continue;
+    }
+
+    ++connected;
+
+    // reset the connection, so the ports don't stay in TIME_WAIT
+    socket.set_option(tcp::socket::linger(true, 0), error);
+    socket.close(error);
+  }
+}
+
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// main
+int main(int argc, char* argv[])
+{
+  try
+  {
+    const po::variables_map vm = handle_command_line(argc, argv);
+
+    const size_t io_services = std::max(vm["io-services"].as<size_t>(), size_t(1));
+    const size_t threads     = std::max(vm["threads"].as<size_t>(), io_services);
+    const size_t connectors  = std::max(vm["connectors"].as<size_t>(), size_t(1));
+    const size_t duration    = vm["duration"].as<size_t>();
+
+    const tcp::endpoint ep(boost::asio::ip::address_v4::loopback(),
+      vm["port"].as<unsigned short>());
+
+    unicomm::config config = unicomm::config()
+      .endpoint(ep)
+      .session_factory(&accept_session::create)
+      .dispatcher_io_services(io_services)
+      .server_acceptors(vm["acceptors"].as<size_t>())
+      .server_pending_accepts(vm["pending"].as<size_t>())
+      .server_accept_burst(vm["burst"].as<size_t>())
+      .comm_pool_size(vm["comm-pool"].as<size_t>());
+
+    unicomm::set_binary_message_format(config);
+
+    unicomm::server server(config);
+    boost::thread_group server_threads;
+
+    server.accept();
+    for (size_t i = 0; i < threads; ++i)
+    {
+      server_threads.create_thread(boost::bind(&server_task, boost::ref(server)));
+    }
+
+    cout << "acceptors = " << config.server_acceptors() << "; pending = "
+      << config.server_pending_accepts() << "; burst = " 
+      << config.server_accept_burst() << "; comm pool = " 
+      << config.comm_pool_size() << "; io services = " << io_services
+      << "; threads = " << threads << "; connectors = " << connectors
+      << "; duration = " << duration << " s" << endl;
+
+    const ptime start    = microsec_clock::universal_time();
+    const ptime deadline = start + seconds(static_cast<long>(duration));
+
+    boost::thread_group connector_threads;
+    for (size_t i = 0; i < connectors; ++i)
+    {
+      connector_threads.create_thread(boost::bind(&connector_task, ep, deadline));
+    }
+
+    connector_threads.join_all();
+
+    // let the server take the rest of the backlog
+    boost::this_thread::sleep(milliseconds(500));
+
+    const double elapsed =
+      (microsec_clock::universal_time() - start).total_milliseconds() / 1000.0;
+
+    cout << "connected = " << connected << "; failed = " << failed
+      << "; accepted = " << accepted << "; accepts per second = "
+      << static_cast<size_t>(accepted / elapsed) << endl;
+
+    const unicomm::dispatcher_stats stats = server.stats();
+
+    cout << "communicators reused = " << stats.comms_reused() 
+      << "; created = " << stats.comms_created() << endl;
+
+    server.stop(seconds(3));
+    server_threads.join_all();
+  }
+  catch (const std::exception& e)
+  {
+    cout << endl << "An error occurred: " << e.what() << endl;
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
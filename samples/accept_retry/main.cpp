@@ -0,0 +1,266 @@
+///////////////////////////////////////////////////////////////////////////////
+// main.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Accept error recovery check. Starts a server, uses up all the file
+// descriptors of the process and connects to the server on the loopback,
+// so every pending accept fails with "too many open files". Then frees
+// the descriptors and fails unless the server accepts all the
+// connections waiting in the backlog.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/unicomm.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (push)
+# pragma warning (disable : 4512)  // warning C4512: 'boost::program_options::options_description' : assignment operator could not be generated
+#endif // _MSC_VER
+
+#include <boost/program_options.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (pop)
+#endif // _MSC_VER
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+
+#include <cstdlib>
+
+#ifndef BOOST_WINDOWS
+
+# include <sys/types.h>
+# include <sys/resource.h>
+# include <fcntl.h>
+# include <unistd.h>
+
+#endif // BOOST_WINDOWS
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using boost::asio::ip::tcp;
+using boost::posix_time::milliseconds;
+using boost::posix_time::seconds;
+
+namespace
+{
+
+namespace po = boost::program_options;
+
+boost::atomic<size_t> accepted(0);
+
+//////////////////////////////////////////////////////////////////////////
+// server session, only counts connections
+class count_session : public unicomm::basic_session<count_session>
+{
+public:
+  explicit count_session(const unicomm::connected_params& /*params*/)
+    { /* empty */ }
+
+protected:
+  void connected_handler(const unicomm::connected_params& /*params*/)
+    { ++accepted; }
+};
+
+//------------------------------------------------------------------------
+po::variables_map handle_command_line(int argc, char* argv[])
+{
+  po::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "Produce help message")
+    ("port,p", po::value<unsigned short>()->default_value(55558),
+      "Port to listen to on the loopback")
+    ("connections,n", po::value<size_t>()->default_value(8),
+      "Connections made while there are no free descriptors")
+    ("acceptors,a", po::value<size_t>()->default_value(2),
+      "Listening sockets count, bound with SO_REUSEPORT if more than one")
+    ("pending,q", po::value<size_t>()->default_value(4),
+      "Accepts pending on each listening socket")
+    ("io-services,i", po::value<size_t>()->default_value(1),
+      "Server io services count");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    cout << desc << endl;
+
+    exit(EXIT_SUCCESS);
+  }
+
+  return vm;
+}
+
+//------------------------------------------------------------------------
+void server_task(unicomm::dispatcher& d)
+{
+  d.run();
+}
+
+#ifndef BOOST_WINDOWS
+
+//------------------------------------------------------------------------
+// keeps the descriptors to be used up from growing too many
+void lower_files_limit(void)
+{
+  rlimit limit;
+
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur > 1024)
+  {
+    limit.rlim_cur = 1024;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+//------------------------------------------------------------------------
+// opens files until the process runs out of descriptors
+std::vector<int> use_up_descriptors(void)
+{
+  std::vector<int> fds;
+
+  for (int fd = open("/dev/null", O_RDONLY); fd >= 0;
+    fd = open("/dev/null", O_RDONLY))
+  {
+    fds.push_back(fd);
+  }
+
+  return fds;
+}
+
+//------------------------------------------------------------------------
+void free_descriptors(const std::vector<int>& fds)
+{
+  for (std::vector<int>::const_iterator cit = fds.begin(); cit != fds.end(); ++cit)
+  {
+    close(*cit);
+  }
+}
+
+#endif // BOOST_WINDOWS
+
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// main
+int main(int argc, char* argv[])
+{
+#ifdef BOOST_WINDOWS
+
+  (void)argc;
+  (void)argv;
+
+  cout << "The check isn't supported on this platform" << endl;
+
+  return EXIT_FAILURE;
+
+#else // BOOST_WINDOWS
+
+  try
+  {
+    const po::variables_map vm = handle_command_line(argc, argv);
+
+    const size_t n           = std::max(vm["connections"].as<size_t>(), size_t(1));
+    const size_t io_services = std::max(vm["io-services"].as<size_t>(), size_t(1));
+
+    const tcp::endpoint ep(boost::asio::ip::address_v4::loopback(),
+      vm["port"].as<unsigned short>());
+
+    unicomm::config config = unicomm::config()
+      .endpoint(ep)
+      .session_factory(&count_session::create)
+      .dispatcher_io_services(io_services)
+      .server_acceptors(vm["acceptors"].as<size_t>())
+      .server_pending_accepts(vm["pending"].as<size_t>());
+
+    unicomm::set_binary_message_format(config);
+
+    unicomm::server server(config);
+    boost::thread_group server_threads;
+
+    server.accept();
+    for (size_t i = 0; i < io_services; ++i)
+    {
+      server_threads.create_thread(boost::bind(&server_task, boost::ref(server)));
+    }
+
+    // client sockets are opened while there are descriptors
+    boost::asio::io_service ioservice;
+    std::vector<boost::shared_ptr<tcp::socket> > sockets;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      sockets.push_back(boost::shared_ptr<tcp::socket>(new tcp::socket(ioservice)));
+      sockets.back()->open(tcp::v4());
+    }
+
+    lower_files_limit();
+
+    const std::vector<int> fds = use_up_descriptors();
+
+    // connections are completed by the system and wait in the backlog,
+    // every accept of them fails
+    for (size_t i = 0; i < n; ++i)
+    {
+      sockets[i]->connect(ep);
+    }
+
+    boost::this_thread::sleep(milliseconds(500));
+
+    const size_t failed_accepted = accepted;
+
+    free_descriptors(fds);
+
+    for (size_t i = 0; i < 50 && accepted < n; ++i)
+    {
+      boost::this_thread::sleep(milliseconds(100));
+    }
+
+    const size_t count = accepted;
+
+    cout << "descriptors used up = " << fds.size() << "; connections = " << n
+      << "; accepted while out of descriptors = " << failed_accepted
+      << "; accepted after they are freed = " << count - failed_accepted << endl;
+
+    sockets.clear();
+
+    server.stop(seconds(3));
+    server_threads.join_all();
+
+    if (count < n)
+    {
+      cout << "Accepting is not recovered after the errors" << endl;
+
+      return EXIT_FAILURE;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    cout << endl << "An error occurred: " << e.what() << endl;
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+
+#endif // BOOST_WINDOWS
+}
@@ -63,6 +63,9 @@ public:
   const std::string& data(void) const { return _data; }
   void data(const std::string& s) { _data = s; }
 
+  // data is overwritten by every unserialize, so the message may be pooled
+  bool resettable(void) const { return true; }
+
 private:
   /** Serializes message to a std::string. */
   std::string serialize(void) const
@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+// main.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Binary escaping benchmark. Escapes and unescapes payloads of random
+// bytes, of special symbols only and of no special symbols by the
+// library's single pass kernels and by the previous in place ones kept
+// here for comparison. Prints the time per payload of both and fails if
+// their results differ.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/unicomm.hpp>
+#include <unicomm/facade/bin_message_encoder.hpp>
+#include <unicomm/facade/bin_message_decoder.hpp>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (push)
+# pragma warning (disable : 4512)  // warning C4512: 'boost::program_options::options_description' : assignment operator could not be generated
+#endif // _MSC_VER
+
+#include <boost/program_options.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (pop)
+#endif // _MSC_VER
+
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+#include <cstdlib>
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
+
+namespace
+{
+
+namespace po = boost::program_options;
+
+//////////////////////////////////////////////////////////////////////////
+// previous kernels, escape and unescape symbols by inserting and erasing
+const char escape_sym = '\xfe';
+const char end_sym    = '\xff';
+
+//------------------------------------------------------------------------
+string& in_place_encode(string& s)
+{
+  for (string::iterator it = s.begin(); it != s.end(); ++it)
+  {
+    if (*it == escape_sym || *it == end_sym)
+    {
+      *it = *it ^ 0x40;
+      it  = s.insert(it, escape_sym);
+      ++it; // now points to just processed byte
+    }
+  }
+
+  return s;
+}
+
+//------------------------------------------------------------------------
+string& in_place_decode(string& s)
+{
+  for (string::iterator it = s.begin(); it != s.end(); ++it)
+  {
+    if (*it == escape_sym)
+    {
+      if ((it = s.erase(it)) == s.end())
+      {
+        throw std::runtime_error("Can't decode [Data is invalid]");
+      }
+
+      *it = *it ^ 0x40;
+    }
+  }
+
+  return s;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// payloads
+string random_payload(size_t size)
+{
+  string s(size, '\0');
+
+  // fixed seed, so the runs are comparable
+  unsigned int seed = 12345;
+  for (string::iterator it = s.begin(); it != s.end(); ++it)
+  {
+    seed = seed * 1103515245 + 12345;
+    *it  = static_cast<char>(seed >> 16);
+  }
+
+  return s;
+}
+
+//------------------------------------------------------------------------
+string special_payload(size_t size)
+{
+  return string(size, end_sym);
+}
+
+//------------------------------------------------------------------------
+string clean_payload(size_t size)
+{
+  return string(size, 'a');
+}
+
+//////////////////////////////////////////////////////////////////////////
+// measuring
+typedef string& (*kernel_type)(string& s);
+
+//------------------------------------------------------------------------
+// milliseconds per run, the result of the last run is returned
+double measure(kernel_type kernel, const string& input, size_t runs, string& result)
+{
+  const ptime start = microsec_clock::universal_time();
+
+  for (size_t i = 0; i < runs; ++i)
+  {
+    result = input;
+    kernel(result);
+  }
+
+  return (microsec_clock::universal_time() - start).total_microseconds() / 1000.0 / runs;
+}
+
+//------------------------------------------------------------------------
+bool compare(const string& name, const string& payload, size_t runs)
+{
+  string old_encoded;
+  string new_encoded;
+  string old_decoded;
+  string new_decoded;
+
+  const double old_encode = measure(&in_place_encode, payload, runs, old_encoded);
+  const double new_encode = measure(&unicomm::binary_encode, payload, runs, new_encoded);
+  const double old_decode = measure(&in_place_decode, old_encoded, runs, old_decoded);
+  const double new_decode = measure(&unicomm::binary_decode, new_encoded, runs, new_decoded);
+
+  cout << name << ": encode " << old_encode << " -> " << new_encode
+    << " ms; decode " << old_decode << " -> " << new_decode << " ms" << endl;
+
+  return old_encoded == new_encoded && old_decoded == payload && new_decoded == payload;
+}
+
+//------------------------------------------------------------------------
+po::variables_map handle_command_line(int argc, char* argv[])
+{
+  po::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "Produce help message")
+    ("size,s", po::value<size_t>()->default_value(65536),
+      "Payload size in bytes")
+    ("runs,r", po::value<size_t>()->default_value(20),
+      "Runs per kernel and payload");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    cout << desc << endl;
+
+    exit(EXIT_SUCCESS);
+  }
+
+  return vm;
+}
+
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// main
+int main(int argc, char* argv[])
+{
+  try
+  {
+    const po::variables_map vm = handle_command_line(argc, argv);
+
+    const size_t size = vm["size"].as<size_t>();
+    const size_t runs = std::max(vm["runs"].as<size_t>(), size_t(1));
+
+    cout << "payload size = " << size << " bytes; runs = " << runs
+      << "; time per payload, in place -> single pass" << endl;
+
+    const bool ok =
+      compare("random bytes", random_payload(size), runs) &
+      compare("special symbols only", special_payload(size), runs) &
+      compare("no special symbols", clean_payload(size), runs);
+
+    if (!ok)
+    {
+      cout << "Results of the kernels differ" << endl;
+
+      return EXIT_FAILURE;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    cout << endl << "An error occurred: " << e.what() << endl;
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
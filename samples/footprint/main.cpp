@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+// main.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Idle connection footprint benchmark. Starts a server, makes a child
+// process open the given number of connections to it on the loopback
+// and leave them idle. Prints the size of the server's communicator and
+// how much the server's resident memory has grown per connection.
+// Fails if the growth exceeds the given limit, so it can be used to keep
+// the footprint from regressing.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/unicomm.hpp>
+#include <unicomm/server_comm.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/asio.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (push)
+# pragma warning (disable : 4512)  // warning C4512: 'boost::program_options::options_description' : assignment operator could not be generated
+#endif // _MSC_VER
+
+#include <boost/program_options.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (pop)
+#endif // _MSC_VER
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <cstdlib>
+
+#ifndef BOOST_WINDOWS
+
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <sys/resource.h>
+# include <unistd.h>
+
+#endif // BOOST_WINDOWS
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using boost::asio::ip::tcp;
+using boost::posix_time::milliseconds;
+using boost::posix_time::seconds;
+
+namespace
+{
+
+namespace po = boost::program_options;
+
+boost::atomic<size_t> accepted(0);
+
+//////////////////////////////////////////////////////////////////////////
+// server session, only counts connections
+class idle_session : public unicomm::basic_session<idle_session>
+{
+public:
+  explicit idle_session(const unicomm::connected_params& /*params*/)
+    { /* empty */ }
+
+protected:
+  void connected_handler(const unicomm::connected_params& /*params*/)
+    { ++accepted; }
+};
+
+//------------------------------------------------------------------------
+po::variables_map handle_command_line(int argc, char* argv[])
+{
+  po::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "Produce help message")
+    ("port,p", po::value<unsigned short>()->default_value(55557),
+      "Port to listen to on the loopback")
+    ("connections,n", po::value<size_t>()->default_value(10000),
+      "Idle connections count")
+    ("io-services,i", po::value<size_t>()->default_value(1),
+      "Server io services count")
+    ("limit,l", po::value<size_t>()->default_value(0),
+      "Fail if resident memory grows more bytes per connection, 0 = no check");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    cout << desc << endl;
+
+    exit(EXIT_SUCCESS);
+  }
+
+  return vm;
+}
+
+//------------------------------------------------------------------------
+void server_task(unicomm::dispatcher& d)
+{
+  d.run();
+}
+
+#ifndef BOOST_WINDOWS
+
+//------------------------------------------------------------------------
+// resident set size in bytes, 0 if unknown
+size_t resident_memory(void)
+{
+  std::ifstream statm("/proc/self/statm");
+
+  size_t total = 0;
+  size_t resident = 0;
+
+  if (!(statm >> total >> resident))
+  {
+    return 0;
+  }
+
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+//------------------------------------------------------------------------
+void raise_files_limit(void)
+{
+  rlimit limit;
+
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+  {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+//------------------------------------------------------------------------
+// opens the connections, holds them until the pipe is closed
+int connector_process(const tcp::endpoint& ep, size_t n, int ready_fd, int done_fd)
+{
+  char c = 0;
+
+  if (read(ready_fd, &c, 1) != 1)
+  {
+    return EXIT_FAILURE;
+  }
+
+  boost::asio::io_service ioservice;
+  std::vector<boost::shared_ptr<tcp::socket> > sockets;
+
+  sockets.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    boost::shared_ptr<tcp::socket> socket(new tcp::socket(ioservice));
+    boost::system::error_code error;
+
+    socket->connect(ep, error);
+    if (error)
+    {
+      cout << "Connect failed after " << i << " connections ["
+        << error.message() << "]" << endl;
+
+      break;
+    }
+
+    sockets.push_back(socket);
+  }
+
+  c = 1;
+  if (write(done_fd, &c, 1) != 1)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // wait for the parent to finish measuring
+  while (read(ready_fd, &c, 1) > 0) { /* empty */ }
+
+  return EXIT_SUCCESS;
+}
+
+#endif // BOOST_WINDOWS
+
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// main
+int main(int argc, char* argv[])
+{
+#ifdef BOOST_WINDOWS
+
+  (void)argc;
+  (void)argv;
+
+  cout << "The benchmark isn't supported on this platform" << endl;
+
+  return EXIT_FAILURE;
+
+#else // BOOST_WINDOWS
+
+  try
+  {
+    const po::variables_map vm = handle_command_line(argc, argv);
+
+    const size_t n          = vm["connections"].as<size_t>();
+    const size_t io_services = std::max(vm["io-services"].as<size_t>(), size_t(1));
+    const size_t limit      = vm["limit"].as<size_t>();
+
+    const tcp::endpoint ep(boost::asio::ip::address_v4::loopback(),
+      vm["port"].as<unsigned short>());
+
+    raise_files_limit();
+
+    int ready_pipe[2];
+    int done_pipe[2];
+
+    if (pipe(ready_pipe) != 0 || pipe(done_pipe) != 0)
+    {
+      throw std::runtime_error("Can't create pipe");
+    }
+
+    // fork before any thread is started
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+      throw std::runtime_error("Can't fork");
+    }
+
+    if (pid == 0)
+    {
+      close(ready_pipe[1]);
+      close(done_pipe[0]);
+
+      _exit(connector_process(ep, n, ready_pipe[0], done_pipe[1]));
+    }
+
+    close(ready_pipe[0]);
+    close(done_pipe[1]);
+
+    unicomm::config config = unicomm::config()
+      .endpoint(ep)
+      .session_factory(&idle_session::create)
+      .dispatcher_io_services(io_services);
+
+    unicomm::set_binary_message_format(config);
+
+    unicomm::server server(config);
+    boost::thread_group server_threads;
+
+    server.accept();
+    for (size_t i = 0; i < io_services; ++i)
+    {
+      server_threads.create_thread(boost::bind(&server_task, boost::ref(server)));
+    }
+
+    // let the server settle down
+    boost::this_thread::sleep(milliseconds(500));
+
+    const size_t before = resident_memory();
+
+    char c = 1;
+    if (write(ready_pipe[1], &c, 1) != 1 || read(done_pipe[0], &c, 1) != 1)
+    {
+      throw std::runtime_error("Connecting process has failed");
+    }
+
+    for (size_t i = 0; i < 600 && accepted < n; ++i)
+    {
+      boost::this_thread::sleep(milliseconds(100));
+    }
+
+    // let the first reads be started
+    boost::this_thread::sleep(milliseconds(500));
+
+    const size_t after = resident_memory();
+    const size_t count = accepted;
+    const size_t per_connection = count == 0? 0:
+      (after > before? after - before: 0) / count;
+
+    cout << "sizeof(server_communicator) = " << sizeof(unicomm::server_communicator)
+      << "; connections = " << count << "; resident memory growth = "
+      << (after > before? after - before: 0) << " bytes; per connection = "
+      << per_connection << " bytes" << endl;
+
+    close(ready_pipe[1]);
+    waitpid(pid, 0, 0);
+
+    server.stop(seconds(3));
+    server_threads.join_all();
+
+    if (count < n)
+    {
+      cout << "Not all the connections are accepted" << endl;
+
+      return EXIT_FAILURE;
+    }
+
+    if (limit != 0 && per_connection > limit)
+    {
+      cout << "Footprint limit of " << limit << " bytes per connection "
+        << "is exceeded" << endl;
+
+      return EXIT_FAILURE;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    cout << endl << "An error occurred: " << e.what() << endl;
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+
+#endif // BOOST_WINDOWS
+}
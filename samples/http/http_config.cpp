@@ -64,6 +64,8 @@ unicomm::config& uni_http::server_config(void)
     (
       common_config()
         .dispatcher_idle_tout(10)
+        // idle timeout is tracked by the after processed handler
+        .dispatcher_idle_process_all(true)
         .message_factory
           (
             message_base::factory_type(&unicomm::create<uni_http::request>)
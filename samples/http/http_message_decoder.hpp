@@ -43,12 +43,14 @@ public:
   }
 
 public:
-  message_decoder(void): _length(0), _last_buf_size(0) { /* emtpy */ }
+  message_decoder(void): _length(0) { /* emtpy */ }
 
 //////////////////////////////////////////////////////////////////////////
 // private stuff
 private:
-  virtual iter_pair_type find_raw_message(unicomm::comm_buffer::buffer_type& buffer, 
+  virtual iter_pair_type find_raw_message(const unicomm::comm_buffer::view_type& buffer,  
+    unicomm::session_base& session);
+  virtual size_t scanned_length(const unicomm::comm_buffer::view_type& buffer, 
     unicomm::session_base& session);
   virtual std::string& decode_raw_message(std::string& raw_message, 
     unicomm::session_base& session);
@@ -56,11 +58,10 @@ private:
     unicomm::session_base& session);
 
 private:
-  iter_pair_type finish_decode(unicomm::in_buffer_type& buffer);
+  iter_pair_type finish_decode(const unicomm::comm_buffer::view_type& buffer);
 
 private:
   size_t _length;
-  size_t _last_buf_size;
 };
 
 } // namespace unicomm
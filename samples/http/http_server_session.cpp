@@ -20,6 +20,7 @@
 #include "http_except.hpp"
 
 #include <unicomm/comm.hpp>
+#include <unicomm/except.hpp>
 
 #include <smart/debug_out.hpp>
 
@@ -41,7 +42,6 @@
 
 #include <sstream>
 #include <stdexcept>
-#include <fstream>
 #include <vector>
 #include <iomanip>
 #include <algorithm>
@@ -49,7 +49,6 @@
 #include <ctime>
 
 using std::stringstream;
-using std::ifstream;
 using std::string;
 using std::setprecision;
 using std::setw;
@@ -322,7 +321,18 @@ void uni_http::server_session::message_arrived_handler(
 
   const request& inm = static_cast<const request&>(params.in_message());
   const response::pointer_type outm = process_request(inm);
-  params.out_message(outm);
+
+  if (_body)
+  {
+    // the file isn't loaded, it's sent by chunks behind the headers, 
+    // the same priority keeps the order
+    params.comm().send(*outm);
+    params.comm().send_stream(_body, outm->priority());
+    _body.reset();
+  } else
+  {
+    params.out_message(outm);
+  }
 
   stringstream ss;
 
@@ -402,20 +412,24 @@ uni_http::server_session::handle_get_file(const server_session::check_resource_r
   const path& file_path   = r.requested_target();
   const string file_name  = r.requested_target().string();
 
-  ifstream file(file_name.c_str(), ifstream::binary);
-  if (!file)
+  unicomm::message_stream::pointer_type body;
+  try
+  {
+    body.reset(new unicomm::file_stream(file_name));
+  }
+  catch (const unicomm::message_stream_error&)
   {
     throw internal_server_error("Can't handle GET request, file [" + file_name + "]");
   }
 
-  buffer_type buf(static_cast<buffer_type::size_type>(file_size(file_path)));
-  file.read(&*buf.begin(), static_cast<std::streamsize>(buf.size()));
-
-  response::pointer_type rr = create_reply(status_code::ok(), 
-    string(buf.begin(), buf.end()));
+  response::pointer_type rr = create_reply(status_code::ok());
   const string file_ext  = boost_path_workaround(file_path.extension());
 
   rr->add_header(header::content_type(), mime_type::ext_to_mime(file_ext));
+  rr->add_header(header::content_length(), 
+    lexical_cast<string>(file_size(file_path)));
+
+  _body = body;
 
   return rr;
 }
@@ -27,6 +27,8 @@
 #include "http_message_base.hpp"
 #include "http_basic.hpp"
 
+#include <unicomm/message_stream.hpp>
+
 #include <smart/timers.hpp>
 
 #include <boost/bind.hpp>
@@ -190,6 +192,8 @@ private:
   hosts_collection_type _served_hosts;
   smart::timeout _timeout;
   bool _track_tout;
+  // requested file, it's streamed behind the reply headers
+  unicomm::message_stream::pointer_type _body;
 };
 
 } // namespace uni_http
@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////////////
+// main.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Outgoing queue benchmark. A number of threads push messages of mixed
+// priorities into the queue at once, then the queue is drained, so it
+// gets deep. Runs the bucketed priority queue the communicator uses and
+// the previous synchronized stable priority queue on a deque. Prints the
+// time both have taken and fails if any of them pops the messages out of
+// order.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/detail/priority_queue_detail.hpp>
+
+#include <smart/sync_objects.hpp>
+#include <smart/stable_priority_queue.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (push)
+# pragma warning (disable : 4512)  // warning C4512: 'boost::program_options::options_description' : assignment operator could not be generated
+#endif // _MSC_VER
+
+#include <boost/program_options.hpp>
+
+#ifdef _MSC_VER
+# pragma warning (pop)
+#endif // _MSC_VER
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+
+#include <cstdlib>
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
+
+namespace
+{
+
+namespace po = boost::program_options;
+
+//////////////////////////////////////////////////////////////////////////
+// queued message, the same as the communicator's prepared message
+class message
+{
+public:
+  message(void): _producer(0), _seq(0), _priority(0) { /* empty */ }
+
+  message(size_t producer, size_t seq, size_t priority):
+    _producer(producer),
+    _seq(seq),
+    _name("message"),
+    _priority(priority),
+    _out_buffer(new string(64, 'a'))
+  {
+    // empty
+  }
+
+public:
+  size_t producer(void) const { return _producer; }
+  size_t seq(void) const { return _seq; }
+  size_t priority(void) const { return _priority; }
+
+  void swap(message& other)
+  {
+    std::swap(_producer, other._producer);
+    std::swap(_seq, other._seq);
+    _name.swap(other._name);
+    std::swap(_priority, other._priority);
+    _out_buffer.swap(other._out_buffer);
+  }
+
+private:
+  size_t _producer;
+  size_t _seq;
+  string _name;
+  size_t _priority;
+  boost::shared_ptr<string> _out_buffer;
+};
+
+//------------------------------------------------------------------------
+bool operator<(const message& l, const message& r)
+{
+  return l.priority() < r.priority();
+}
+
+//------------------------------------------------------------------------
+bool operator>(const message& l, const message& r)
+{
+  return l.priority() > r.priority();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// queues
+typedef unicomm::detail::bucket_priority_queue<message> bucket_queue_type;
+
+typedef smart::sync_queue<
+  message,
+  smart::stable_priority_queue<
+    message,
+    std::deque<message>, std::greater<message> >
+> stable_queue_type;
+
+//------------------------------------------------------------------------
+// 8 low levels and a few levels above the directly addressed ones
+size_t priority_of(size_t seq)
+{
+  return seq % 97 == 0? 1000 + seq % 3: seq % 8;
+}
+
+//------------------------------------------------------------------------
+void push_bucket(bucket_queue_type& q, size_t producer, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    message m(producer, i, priority_of(i));
+
+    q.push(m);
+  }
+}
+
+//------------------------------------------------------------------------
+void push_stable(stable_queue_type& q, size_t producer, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    q.push(message(producer, i, priority_of(i)));
+  }
+}
+
+//------------------------------------------------------------------------
+bool pop_bucket(bucket_queue_type& q, message& m)
+{
+  return q.pop(m);
+}
+
+//------------------------------------------------------------------------
+bool pop_stable(stable_queue_type& q, message& m)
+{
+  if (q.empty())
+  {
+    return false;
+  }
+
+  m = q.front_copy();
+  q.pop();
+
+  return true;
+}
+
+//------------------------------------------------------------------------
+// milliseconds taken, ok is set if all the messages are popped in order
+template <typename QueueT>
+double run(void (*push)(QueueT&, size_t, size_t), bool (*pop)(QueueT&, message&),
+           size_t producers, size_t n, bool& ok)
+{
+  QueueT q;
+
+  const ptime start = microsec_clock::universal_time();
+
+  boost::thread_group threads;
+  for (size_t i = 0; i < producers; ++i)
+  {
+    threads.create_thread(boost::bind(push, boost::ref(q), i, n));
+  }
+
+  threads.join_all();
+
+  // greater priority first, the same priority of a producer in push order
+  std::vector<size_t> last_seq(producers * 2048, size_t(-1));
+  size_t last_priority = size_t(-1);
+  size_t count = 0;
+
+  ok = true;
+
+  for (message m; pop(q, m); ++count)
+  {
+    const size_t key = m.producer() * 2048 + m.priority() % 2048;
+
+    ok = ok && m.priority() <= last_priority &&
+      (last_seq[key] == size_t(-1) || last_seq[key] < m.seq());
+
+    last_priority = m.priority();
+    last_seq[key] = m.seq();
+  }
+
+  ok = ok && count == producers * n;
+
+  return (microsec_clock::universal_time() - start).total_microseconds() / 1000.0;
+}
+
+//------------------------------------------------------------------------
+po::variables_map handle_command_line(int argc, char* argv[])
+{
+  po::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "Produce help message")
+    ("producers,p", po::value<size_t>()->default_value(4),
+      "Pushing threads count")
+    ("messages,n", po::value<size_t>()->default_value(20000),
+      "Messages pushed by each thread");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    cout << desc << endl;
+
+    exit(EXIT_SUCCESS);
+  }
+
+  return vm;
+}
+
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// main
+int main(int argc, char* argv[])
+{
+  try
+  {
+    const po::variables_map vm = handle_command_line(argc, argv);
+
+    const size_t producers = std::max(vm["producers"].as<size_t>(), size_t(1));
+    const size_t n         = vm["messages"].as<size_t>();
+
+    cout << "producers = " << producers << "; messages per producer = " << n
+      << "; queue depth = " << producers * n << endl;
+
+    bool bucket_ok = false;
+    bool stable_ok = false;
+
+    const double bucket = run(&push_bucket, &pop_bucket, producers, n, bucket_ok);
+    const double stable = run(&push_stable, &pop_stable, producers, n, stable_ok);
+
+    cout << "stable priority queue = " << stable << " ms; bucket priority queue = "
+      << bucket << " ms" << endl;
+
+    if (!bucket_ok || !stable_ok)
+    {
+      cout << "Messages are popped out of order; bucket = " << bucket_ok
+        << "; stable = " << stable_ok << endl;
+
+      return EXIT_FAILURE;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    cout << endl << "An error occurred: " << e.what() << endl;
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// buffer_pool.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Receive buffers pool.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/buffer_pool.hpp>
+
+#include <boost/assert.hpp>
+
+//////////////////////////////////////////////////////////////////////////
+// buffer_pool
+unicomm::buffer_pool::buffer_pool(size_t buffer_size, size_t max_idle):
+  _idle(max_idle),
+  _buffer_size(buffer_size)
+{
+  BOOST_ASSERT(buffer_size > 0 && " - Buffer size can't be zero");
+}
+
+//-----------------------------------------------------------------------------
+unicomm::buffer_pool::buffer_ptr_type unicomm::buffer_pool::acquire(void)
+{
+  buffer_ptr_type buf;
+  if (!_idle.acquire(buf))
+  {
+    // allocate outside the lock
+    buf.reset(new buffer_type(_buffer_size));
+    _idle.created();
+  }
+
+  return buf;
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::buffer_pool::release(const buffer_ptr_type& buf)
+{
+  BOOST_ASSERT(buf && " - Null buffer can't be released");
+  BOOST_ASSERT(buf->size() == _buffer_size && " - Foreign buffer is released");
+
+  // freed by the caller's reference if the pool is full
+  _idle.release(buf);
+}
+
@@ -180,6 +180,8 @@ void unicomm::client::on_reset(void)
 void unicomm::client::initialize(void)
 {
   _conn_errors.clear();
+  // communicators for the connections to come
+  reserve_comms<client_communicator>();
 
 #ifdef UNICOMM_SSL
 
@@ -247,6 +249,9 @@ void unicomm::client::asio_connect_handler(const comm_ptr& client,
 
       info.error_code(error);
       reg_conn_error(info);
+
+      // tell to process
+      kick_dispatcher();
     } else
     {
       // add client
@@ -267,13 +272,13 @@ void unicomm::client::asio_connect_handler(const comm_ptr& client,
 
 #endif // UNICOMM_SSL
 
+      // tell to process
+      kick_dispatcher(*client);
+
       UNICOMM_DEBUG_OUT("[unicomm::client]: Client connected; comm ID = " 
         << std::dec << client->id() << "; remote ep = " << client->remote_endpoint())
     }
 
-    // tell to process
-    kick_dispatcher();
-
     UNICOMM_DEBUG_OUT("[unicomm::client]: Asio connect finished; comm ID = " 
       << std::dec << client->id())
 }
@@ -50,7 +50,8 @@ unicomm::client_communicator::~client_communicator(void)
 void unicomm::client_communicator::asio_success_connect_handler(
   const asio_handshake_handler_type& handler) 
 {
-  ssl_socket().async_handshake(boost::asio::ssl::stream_base::client, handler);
+  ssl_socket().async_handshake(boost::asio::ssl::stream_base::client, 
+    strand().wrap(handler));
 }
 
 #endif // UNICOMM_SSL
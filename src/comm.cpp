@@ -15,8 +15,11 @@
 #include <unicomm/dispatcher.hpp>
 #include <unicomm/basic.hpp>
 #include <unicomm/config.hpp>
+#include <unicomm/message_types.hpp>
 #include <unicomm/except.hpp>
 
+#include <detail/basic_detail.hpp>
+
 #include <smart/scoped_sentinel.hpp>
 #include <smart/debug_out.hpp>
 #include <smart/timers.hpp>
@@ -70,6 +73,8 @@ using boost::asio::buffers_begin;
 using boost::system::error_code;
 using boost::posix_time::milliseconds;
 
+using unicomm::detail::spin_mutex;
+
 using smart::generic_scoped_sentinel;
 using smart::scoped_sentinel;
 
@@ -97,29 +102,28 @@ check_session_factory(const unicomm::session_base::factory_type& factory)
   return factory;
 }
 
-} // unnamed namespace
-
-//////////////////////////////////////////////////////////////////////////
-// communicator
-
-namespace unicomm
+//------------------------------------------------------------------------
+// takes the data over without copying
+unicomm::shared_out_buffer_type take_raw_data(unicomm::out_buffer_type& data)
 {
+  boost::shared_ptr<unicomm::out_buffer_type> shared(new unicomm::out_buffer_type);
 
-/** Compares prepared messages. */
-inline bool operator<(const communicator::prepeared_message& l, 
-                      const communicator::prepeared_message& r)
-{
-  return l.priority() < r.priority();
+  shared->swap(data);
+
+  return shared;
 }
 
-/** Compares prepared messages. */
-inline bool operator>(const communicator::prepeared_message& l, 
-                      const communicator::prepeared_message& r)
+//------------------------------------------------------------------------
+inline size_t stream_chunk_size(const unicomm::config& conf)
 {
-  return l.priority() > r.priority();
+  return conf.stream_chunk_size() == 0? 
+    unicomm::detail::default_stream_chunk_size(): conf.stream_chunk_size();
 }
 
-} // namespace unicomm
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// communicator
 
 #ifdef UNICOMM_SSL
 
@@ -127,6 +131,7 @@ unicomm::communicator::communicator(dispatcher& owner,
                                     io_service& ioservice, 
                                     boost::asio::ssl::context& context, 
                                     const unicomm::config& config):
+  _strand(ioservice),
   _socket(ioservice, context),
 
 #else
@@ -134,16 +139,21 @@ unicomm::communicator::communicator(dispatcher& owner,
 unicomm::communicator::communicator(dispatcher& owner, 
                                     io_service& ioservice, 
                                     const unicomm::config& config):
+  _strand(ioservice),
   _socket(ioservice),
 
 #endif // UNICOMM_SSL
   _id(owner.new_commid()),
   _mesid(undefined_messageid()),
+  _timeout_serial(0),
   _connected(false),
   _just_connected(false),
+  _session_valid(false),
   _config(&config),
   _owner(owner),
   _in_buffer_updated(false),
+  _ready_events(0),
+  _shard(0),
 
 #ifdef UNICOMM_FORK_SUPPORT
   _is_notify_upper(true),
@@ -244,27 +254,94 @@ void unicomm::communicator::close_socket(void)
 
 //-----------------------------------------------------------------------------
 void unicomm::communicator::reg_message_timeout(messageid_type mid, 
-                                                const string& name) const
+                                                message_typeid_type type)
 {
   // register outgoing message
-  const unicomm::config& conf = config();
-
-  const smart::timeout tout(conf.message_timeout_used(name)? 
-    milliseconds(conf.message_timeout(name)): smart::timeout::infinite_timeout());
+  const size_t tout   = config().message_timeout(type);
+  const size_t serial = ++_timeout_serial;
 
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: REGISTER MESSAGE TIMEOUT; comm ID = " 
     << dec << id() << "; message ID = " << mid << "; timeout = " 
-    << conf.message_timeout(name) << " ms; message NAME = " << name)
+    << tout << " ms; message TYPE = " << type)
 
   if (is_timeout_registered(mid))
   {
-    // overwrite existing timeout if same message identifier got
-    _mes_timeouts[mid] = message_timeout_info(name, tout);
+    // overwrite existing timeout if same message identifier got,
+    // previously scheduled one is ignored as its serial doesn't match
+    _mes_timeouts[mid] = message_timeout_info(type, tout, serial);
   } else
   {
     // create new one if doesn't exist
-    _mes_timeouts.insert(make_pair(mid, message_timeout_info(name, tout)));
+    _mes_timeouts.insert(make_pair(mid, message_timeout_info(type, tout, serial)));
   }
+
+  if (!is_infinite_timeout(tout))
+  {
+    owner().schedule_message_timeout(shared_from_this(), mid, serial, tout);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::communicator::timeout_elapsed(messageid_type mid, size_t serial)
+{
+  spin_mutex::scoped_lock lock(_elapsed_mutex);
+
+  _elapsed_timeouts.push_back(make_pair(mid, serial));
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::communicator::recycle(void)
+{
+  UNICOMM_DEBUG_OUT("[unicomm::communicator]: RECYCLING; comm ID = " << dec << id())
+
+  disconnect();
+
+  _id = owner().new_commid();
+  _in_buffer.clear();
+  _sent_messages.clear();
+
+  prepeared_message m;
+  while (_prepeared_m_queue.pop(m)) { /* empty */ }
+
+  _out_buffers.clear();
+  prepeared_message().swap(_out_stream);
+  _write_batch.clear();
+  _mesid = undefined_messageid();
+  // the serial isn't reset, so the timeouts scheduled before are ignored
+  _mes_timeouts.clear();
+
+  {
+    spin_mutex::scoped_lock lock(_elapsed_mutex);
+
+    _elapsed_timeouts.clear();
+  }
+
+  _read_error.clear();
+  _write_error.clear();
+
+#ifdef UNICOMM_SSL
+
+  _handshake_error.clear();
+
+#endif // UNICOMM_SSL
+
+  _connected = false;
+  _just_connected = false;
+  _session_valid = false;
+  // the object is reset by create_user_session() if it's kept
+  if (_user_session && !_user_session->recyclable())
+  {
+    _user_session.reset();
+  }
+
+  _in_buffer_updated = false;
+  _ready_events = 0;
+
+#ifdef UNICOMM_FORK_SUPPORT
+  _is_notify_upper = true;
+#endif // UNICOMM_FORK_SUPPORT
+
+  _internal_mid = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -291,10 +368,21 @@ unicomm::session_base& unicomm::communicator::create_user_session(void)
   {
     try
     {
-      mutex_type::scoped_lock lock(_session_mutex);
+      if (_user_session)
+      {
+        // recycled along with the communicator, it's dropped if reset fails
+        session_base::pointer_type session;
 
-      _user_session = check_session_factory(config().session_factory())
-        (connected_params(*this, _in_buffer));
+        session.swap(_user_session);
+        session->reset(connected_params(*this, _in_buffer));
+        _user_session.swap(session);
+      } else
+      {
+        _user_session = check_session_factory(config().session_factory())
+          (connected_params(*this, _in_buffer));
+      }
+
+      _session_valid = true;
     }
     catch (const std::exception& e)
     {
@@ -326,27 +414,28 @@ unicomm::session_base& unicomm::communicator::user_session(void) const
   BOOST_ASSERT(is_session_valid() && 
     " - An attempt to access invalid session object");
 
-  mutex_type::scoped_lock lock(_session_mutex);
-
   return *_user_session;
 }
 
 //////////////////////////////////////////////////////////////////////////
 // outgoing buffers support
 unicomm::messageid_type 
-unicomm::communicator::out_buffers_insert(const prepeared_message& m)
+unicomm::communicator::out_buffers_insert(prepeared_message& m)
 {
   const messageid_type int_mid = new_internal_mid();
 
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: NEW OUT BUFFER; comm ID = " 
     << dec << id() << "; internal ID = " << int_mid << "; message ID = " 
-    << m.id() << "; message NAME = " << m.name())
+    << m.id() << "; message NAME = " << message_type_name(m.type()))
 
-  std::pair<out_buffers_map_type::const_iterator, bool> result = 
-    _out_buffers.insert(make_pair(int_mid, m));
+  std::pair<out_buffers_map_type::iterator, bool> result = 
+    _out_buffers.insert(make_pair(int_mid, prepeared_message()));
 
   BOOST_ASSERT(result.second && " - Message with such id already exists in buffer");
 
+  // the message is moved to the node, it's left empty
+  result.first->second.swap(m);
+
   return int_mid;
 }
 
@@ -387,40 +476,6 @@ bool unicomm::communicator::is_out_buffers_empty(void) const
   return _out_buffers.empty();
 }
 
-//-----------------------------------------------------------------------------
-unicomm::messageid_type 
-unicomm::communicator::mt_out_buffers_insert(const prepeared_message& m)
-{
-  out_buffer_mutex_type::scoped_lock lock(_out_buf_mutex);
-
-  return out_buffers_insert(m);
-}
-
-//-----------------------------------------------------------------------------
-void unicomm::communicator::mt_out_buffers_erase(messageid_type int_mid)
-{
-  out_buffer_mutex_type::scoped_lock lock(_out_buf_mutex);
-
-  out_buffers_erase(int_mid);
-}
-
-//-----------------------------------------------------------------------------
-const unicomm::communicator::prepeared_message& 
-unicomm::communicator::mt_get_out_buffers_item(messageid_type int_mid) const
-{
-  out_buffer_mutex_type::scoped_lock lock(_out_buf_mutex);
-
-  return get_out_buffers_item(int_mid);
-}
-
-//-----------------------------------------------------------------------------
-bool unicomm::communicator::mt_is_out_buffers_empty(void) const
-{
-  out_buffer_mutex_type::scoped_lock lock(_out_buf_mutex);
-
-  return is_out_buffers_empty();
-}
-
 //////////////////////////////////////////////////////////////////////////
 // misc handlers
 void unicomm::communicator::handle_error(const boost::system::error_code& error, 
@@ -444,60 +499,12 @@ void unicomm::communicator::handle_disconnected(
 }
 
 //-----------------------------------------------------------------------------
-//void unicomm::communicator::mt_handle_ch_error(void)
-//{
-//  bool is_error = false;
-//
-//  { // error lock
-//    mutex_type::scoped_lock lock(_read_err_mutex);
-//    is_error = _read_error || _write_error;
-//  }
-//
-//  if (is_error && mt_is_out_buffers_empty())
-//  {
-//    const boost::system::error_code error = _read_error? _read_error: _write_error;
-//    _read_error.clear();
-//    _write_error.clear();
-//
-//    UNICOMM_DEBUG_OUT("[unicomm::communicator]: Channel error; comm ID = " 
-//      << id() << " [" << error << ", " << error.message() << "]")
-//
-//    const string what = "Channel error";
-//
-//    switch (error.value())
-//    {
-//      // errors list that cause disconnected handler to be invoked
-//      case boost::asio::error::eof:
-//      case boost::asio::error::connection_aborted:
-//      case boost::asio::error::connection_reset:
-//      case boost::asio::error::not_socket:
-//      case boost::asio::error::shut_down:
-//      case boost::asio::error::operation_aborted:
-//      case boost::asio::error::bad_descriptor:
-//        handle_disconnected(error, what);
-//      break;
-//
-//      default:
-//        UNICOMM_DEBUG_OUT("[unicomm::communicator]: UNEXPECTED Channel error; comm ID = " 
-//          << id() << " [" << error << ", " << error.message() << "]")
-//
-//        handle_disconnected(error, what);
-//      break;
-//    }
-//  }
-//}
-
-void unicomm::communicator::mt_handle_ch_error(void)
+void unicomm::communicator::handle_ch_error(void)
 {
-  boost::system::error_code error;
-
-  {
-    mutex_type::scoped_lock lock(_read_err_mutex);
+  const boost::system::error_code error = _read_error? _read_error: _write_error;
 
-    error = _read_error? _read_error: _write_error;
-    _read_error.clear();
-    _write_error.clear();
-  }
+  _read_error.clear();
+  _write_error.clear();
 
   if (error)
   {
@@ -532,7 +539,7 @@ void unicomm::communicator::mt_handle_ch_error(void)
 //-----------------------------------------------------------------------------
 inline void unicomm::communicator::kick_dispatcher(void)
 {
-  owner().kick_dispatcher();
+  owner().kick_dispatcher(*this);
 }
 
 //-----------------------------------------------------------------------------
@@ -552,14 +559,6 @@ void unicomm::communicator::handle_handshake_error(void)
   }
 }
 
-//-----------------------------------------------------------------------------
-void unicomm::communicator::mt_handle_handshake_error(void)
-{
-  mutex_type::scoped_lock lock(_hshake_err_mutex);
-
-  handle_handshake_error();
-}
-
 #endif // UNICOMM_SSL
 
 //-----------------------------------------------------------------------------
@@ -633,9 +632,7 @@ tcp::endpoint unicomm::communicator::local_endpoint(void) const
 //-----------------------------------------------------------------------------
 bool unicomm::communicator::is_session_valid(void) const
 {
-  mutex_type::scoped_lock lock(_session_mutex);
-
-  return _user_session != 0;
+  return _session_valid;
 }
 
 //-----------------------------------------------------------------------------
@@ -731,8 +728,8 @@ void unicomm::communicator::unreg_message_timeout(
 {
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: UNREGISTER MESSAGE TIMEOUT; comm ID = " 
     << dec << id() << "; message ID = " << it->first << "; timeout = " 
-    << it->second.tout().time_out().total_milliseconds() 
-    << " ms; message NAME = " << it->second.name())
+    << it->second.tout() 
+    << " ms; message NAME = " << message_type_name(it->second.type()))
 
   _mes_timeouts.erase(it);
 }
@@ -761,9 +758,9 @@ void unicomm::communicator::reg_sent_message(messageid_type int_mid)
 
     UNICOMM_DEBUG_OUT("[unicomm::communicator]: REGISTER SENT MESSAGE; comm ID = " 
       << dec << id() << "; internal ID = " << int_mid << "; message ID = " 
-      << m.id() << "; message NAME = " << m.name())
+      << m.id() << "; message NAME = " << message_type_name(m.type()))
 
-    _sent_messages.push_back(sent_message_info(int_mid, m.id(), m.name()));
+    _sent_messages.push_back(sent_message_info(int_mid, m.id(), m.type()));
   }
   catch (const std::exception& UNICOMM_IFDEF_DEBUG(e))
   {
@@ -780,7 +777,7 @@ unicomm::communicator::unreg_sent_message(sent_messages_vector_type::iterator it
 {
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: UNREGISTER SENT MESSAGE; comm ID = " 
     << dec << id() << "; internal ID = " << it->int_id() << "; message ID = " 
-    << it->id() << "; message NAME = " << it->name())
+    << it->id() << "; message NAME = " << message_type_name(it->type()))
 
   return _sent_messages.erase(it);
 }
@@ -791,38 +788,6 @@ inline bool unicomm::communicator::is_sent_messages_empty(void) const
   return _sent_messages.empty();
 }
 
-//-----------------------------------------------------------------------------
-void unicomm::communicator::mt_reg_sent_message(messageid_type int_mid)
-{
-  try
-  {
-    const prepeared_message& m = mt_get_out_buffers_item(int_mid);
-
-    UNICOMM_DEBUG_OUT("[unicomm::communicator]: REGISTER SENT MESSAGE; comm ID = " 
-      << dec << id() << "; internal ID = " << int_mid << "; message ID = " 
-      << m.id() << "; message NAME = " << m.name())
-
-    mutex_type::scoped_lock lock(_sent_mes_mutex);
-    _sent_messages.push_back(sent_message_info(int_mid, m.id(), m.name()));
-  }
-  catch (const std::exception& UNICOMM_IFDEF_DEBUG(e))
-  {
-    UNICOMM_DEBUG_OUT("[unicomm::communicator]: Unexpected std::exception [what: " 
-      << e.what() << "]")
-
-    BOOST_ASSERT(!"[unicomm::communicator]: Unexpected std::exception");
-  }
-}
-
-//-----------------------------------------------------------------------------
-inline unicomm::communicator::sent_messages_vector_type::iterator 
-unicomm::communicator::mt_unreg_sent_message(sent_messages_vector_type::iterator it)
-{
-  mutex_type::scoped_lock lock(_sent_mes_mutex);
-
-  return unreg_sent_message(it);
-}
-
 //////////////////////////////////////////////////////////////////////////
 // core - processors
 void unicomm::communicator::mt_process_arrived(void)
@@ -855,79 +820,67 @@ void unicomm::communicator::process_incoming(const message_base& m)
 //-----------------------------------------------------------------------------
 void unicomm::communicator::process_timeouts(void)
 {
-  // fixme: limit loop by timeout also
-  for (messages_timeouts_map_type::iterator it = _mes_timeouts.begin();
-    it != _mes_timeouts.end(); /*++it*/)
+  elapsed_timeouts_type elapsed;
+
   {
-    if (it->second.tout().elapsed())
+    spin_mutex::scoped_lock lock(_elapsed_mutex);
+
+    elapsed.swap(_elapsed_timeouts);
+  }
+
+  // only timeouts elapsed by the dispatcher's timing wheel are considered
+  for (elapsed_timeouts_type::iterator cit = elapsed.begin();
+    cit != elapsed.end(); ++cit)
+  {
+    const messages_timeouts_map_type::iterator it = _mes_timeouts.find(cit->first);
+
+    // reply is received or the message is sent again meanwhile
+    if (it == _mes_timeouts.end() || it->second.serial() != cit->second)
     {
-      const messageid_type mid = it->first;
+      continue;
+    }
+
+    const messageid_type mid = it->first;
 
-      UNICOMM_DEBUG_OUT("[unicomm::communicator]: MESSAGE TIMEOUT ELAPSED; comm ID = " 
-        << dec << id() << "; message ID = " << mid << "; message NAME = " 
-        << it->second.name())
+    UNICOMM_DEBUG_OUT("[unicomm::communicator]: MESSAGE TIMEOUT ELAPSED; comm ID = " 
+      << dec << id() << "; message ID = " << mid << "; message NAME = " 
+      << message_type_name(it->second.type()))
 
-      unreg_message_timeout(it++);
+    unreg_message_timeout(it);
 
+    try
+    {
       // call timeout handler
       call_message_timeout(mid);
-    } else
+    }
+    catch (...)
     {
-      ++it;
+      // the rest is considered by the next processing
+      spin_mutex::scoped_lock lock(_elapsed_mutex);
+
+      _elapsed_timeouts.insert(_elapsed_timeouts.end(), cit + 1, elapsed.end());
+      throw;
     }
   }
 }
 
 //-----------------------------------------------------------------------------
-void unicomm::communicator::mt_process_errors(void)
+void unicomm::communicator::process_errors(void)
 {
 
 #ifdef UNICOMM_SSL
 
-  mt_handle_handshake_error();
+  handle_handshake_error();
 
 #endif // UNICOMM_SSL
 
   // handle any channel error
-  mt_handle_ch_error();
+  handle_ch_error();
 }
 
-////-----------------------------------------------------------------------------
-//void unicomm::communicator::process_sent(void)
-//{
-//  BOOST_ASSERT(!is_sent_messages_empty() && 
-//    " - Sent messages collection could not be empty");
-//
-//  for (sent_messages_vector_type::iterator it = _sent_messages.begin();
-//    it != _sent_messages.end(); /*++it*/)
-//  {
-//    const messageid_type mid = it->id();
-//    const string& name       = it->name();
-//
-//    // register outgoing messages id and its timeout
-//    const unicomm::config& conf = config();
-//    if (conf.timeouts_enabled() && conf.need_reply(name))
-//    {
-//      reg_message_timeout(mid, name);
-//    }
-//
-//    UNICOMM_DEBUG_OUT("[unicomm::communicator]: MESSAGE IS SENT; comm ID = " 
-//      << dec << id() << "; internal ID = " << it->int_id()
-//      << "; message ID = " << mid << "; message NAME = " << name)
-//
-//    // remove entry
-//    it = unreg_sent_message(it);
-//
-//    // notify upper level
-//    call_message_sent(mid);
-//  }
-//}
-
 //-----------------------------------------------------------------------------
-void unicomm::communicator::mt_process_sent(void)
+void unicomm::communicator::process_sent(void)
 {
-  mutex_type::scoped_lock lock(_sent_mes_mutex);
-
   BOOST_ASSERT(!is_sent_messages_empty() && 
     " - Sent messages collection could not be empty");
 
@@ -936,21 +889,13 @@ void unicomm::communicator::mt_process_sent(void)
     it != _sent_messages.end(); /*++it*/)
   {
     const messageid_type mid = it->id();
-    const string& name       = it->name();
-
-    // register outgoing messages id and its timeout
-    const unicomm::config& conf = config();
-    if (conf.timeouts_enabled() && conf.need_reply(name))
-    {
-      reg_message_timeout(mid, name);
-    }
 
     UNICOMM_DEBUG_OUT("[unicomm::communicator]: MESSAGE IS SENT; comm ID = " 
       << dec << id() << "; internal ID = " << it->int_id()
-      << "; message ID = " << mid << "; message NAME = " << name)
+      << "; message ID = " << mid << "; message NAME = " << message_type_name(it->type()))
 
     // remove entry
-    it = unreg_sent_message(it);//_sent_messages.erase(it);
+    it = unreg_sent_message(it);
 
     // notify upper level
     call_message_sent(mid);
@@ -1031,16 +976,15 @@ void unicomm::communicator::process_reply(const message_base& m)
       << dec << id() << "; message ID = " << get_id(m) << "; message RID = "
       << get_rid(m) << "; message NAME = " << get_name(m))
 
-    const string& rep_name      = get_name(m);
-    const unicomm::config& conf = config();
-    const string& req_name      = get_message_timeout(rep_mid).name();
+    const unicomm::config& conf          = config();
+    const message_typeid_type req_type = get_message_timeout(rep_mid).type();
 
-    if (!is_allowed_reply(conf, req_name, rep_name))
+    if (!is_allowed_reply(conf, req_type, conf.message_type(m)))
     {
       stringstream ss;
       ss << "Received reply is not allowed; message id [" << get_id(m)
-        << "]; message rid [" << rep_mid << "]; request name [" << req_name
-        << "]; reply name [" << rep_name << "]";
+        << "]; message rid [" << rep_mid << "]; request name [" 
+        << message_type_name(req_type) << "]; reply name [" << get_name(m) << "]";
 
       UNICOMM_DEBUG_OUT(
         "[unicomm::communicator]: DISALLOWED REPLY MESSAGE RECEIVED; comm ID = "
@@ -1095,54 +1039,45 @@ void unicomm::communicator::mt_process(void)
   //UNICOMM_DEBUG_OUT("[unicomm::communicator]: Process ENTER; comm ID = "
   //  << dec << id() << _::session_name(*this))
 
-  this_mutex_type::scoped_try_lock lock(_this_mutex);
-
-  // process if locked
-  if (lock.owns_lock())
+  // executed through the strand, so neither asio handlers 
+  // nor other threads can interfere
+  // process connected
+  if (just_connected())
   {
-    //UNICOMM_DEBUG_OUT("[unicomm::communicator]: Process OBJECT LOCKED; comm ID = "
-    //  << dec << id() << _::session_name(*this))
-    // process connected
-    if (just_connected())
-    {
-      just_connected(false);
-      process_connect();
-    }
-
-    // the order of sent processing matters
-    // request data from one of previous iterations is sent
-    if (mt_is_write_completed_successfully())
-    {
-      mt_process_sent();
-    }
+    just_connected(false);
+    process_connect();
+  }
 
-    // try to process arrived data if there is something to process
-    if (mt_is_arrived())
-    {
-      mt_process_arrived();
-    }
+  // the order of sent processing matters
+  // request data from one of previous iterations is sent
+  if (is_write_completed_successfully())
+  {
+    process_sent();
+  }
 
-    // try to start writing if necessary - if there is something to write
-    if (is_ready_to_write())
-    {
-      mt_start_write();
-    }
+  // try to process arrived data if there is something to process
+  if (mt_is_arrived())
+  {
+    mt_process_arrived();
+  }
 
-    // consider timeouts
-    if (config().timeouts_enabled())
-    {
-      process_timeouts();
-    }
+  // try to start writing if necessary - if there is something to write
+  if (is_ready_to_write())
+  {
+    mt_start_write();
+  }
 
-    // process errors
-    mt_process_errors();
+  // consider timeouts
+  if (config().timeouts_enabled())
+  {
+    process_timeouts();
+  }
 
-    // call after processed handler
-    call_after_processed();
+  // process errors
+  process_errors();
 
-    //UNICOMM_DEBUG_OUT("[unicomm::communicator]: Process ABOUT TO UNLOCK OBJECT; comm ID = "
-    //  << dec << id() << _::session_name(*this))
-  }
+  // call after processed handler
+  call_after_processed();
 
   //UNICOMM_DEBUG_OUT("[unicomm::communicator]: Process EXIT; comm ID = "
   //  << dec << id() << _::session_name(*this))
@@ -1151,7 +1086,9 @@ void unicomm::communicator::mt_process(void)
 //-----------------------------------------------------------------------------
 unicomm::messageid_type unicomm::communicator::send(const message_base &message)
 {
-  return prepare_to_write(message);
+  shared_out_buffer_type out_buffer;
+
+  return prepare_to_write(message, out_buffer);
 }
 
 //-----------------------------------------------------------------------------
@@ -1186,7 +1123,127 @@ unicomm::communicator::send(const message_base &message,
 
 //-----------------------------------------------------------------------------
 unicomm::messageid_type 
-unicomm::communicator::prepare_to_write(const message_base &message)
+unicomm::communicator::send_broadcast(const message_base &message, 
+                                      shared_out_buffer_type& out_buffer)
+{
+  return prepare_to_write(message, out_buffer);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::send_broadcast(const message_base &message, 
+                                      shared_out_buffer_type& out_buffer, 
+                                      const message_sent_handler_type& handler)
+{
+  const unicomm::messageid_type mid = send_broadcast(message, out_buffer);
+
+  if (handler)
+  {
+    session().reg_messsage_sent(mid, handler);
+  }
+
+  return mid;
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::send_raw(const shared_out_buffer_type& data, 
+                                size_t priority,
+                                const message_sent_handler_type& handler)
+{
+  BOOST_ASSERT(data && !data->empty() && " - Raw data to be sent can't be empty");
+
+  return push_raw(data, message_stream::pointer_type(), priority, handler);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::send_raw(const shared_out_buffer_type& data, 
+                                size_t priority,
+                                const message_sent_handler_type& handler) const
+{
+  return owner().send_raw_one(id(), data, priority, handler);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::send_raw(out_buffer_type& data, size_t priority,
+                                const message_sent_handler_type& handler)
+{
+  return send_raw(take_raw_data(data), priority, handler);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::send_raw(out_buffer_type& data, size_t priority,
+                                const message_sent_handler_type& handler) const
+{
+  return send_raw(take_raw_data(data), priority, handler);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::send_stream(const message_stream::pointer_type& stream, 
+                                   size_t priority,
+                                   const message_sent_handler_type& handler)
+{
+  BOOST_ASSERT(stream && " - Stream to be sent can't be null");
+
+  return push_raw(shared_out_buffer_type(), stream, priority, handler);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::send_stream(const message_stream::pointer_type& stream, 
+                                   size_t priority,
+                                   const message_sent_handler_type& handler) const
+{
+  return owner().send_stream_one(id(), stream, priority, handler);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::push_raw(const shared_out_buffer_type& data, 
+                                const message_stream::pointer_type& stream, 
+                                size_t priority,
+                                const message_sent_handler_type& handler)
+{
+  const unicomm::config& conf = config();
+
+  // the data carries no id, so it's always assigned
+  // to let the sent handler identify the data
+  const messageid_type mid = new_mid();
+
+  if (conf.use_default_message_priority() && is_undefined_priority(priority))
+  {
+    priority = conf.default_priority();
+  }
+
+  // registered before the data is queued, so it's
+  // not possible the data is sent before that
+  if (handler)
+  {
+    session().reg_messsage_sent(mid, handler);
+  }
+
+  prepeared_message pm(mid, undefined_message_typeid(), priority, data, stream);
+
+  push_prepeared_message(pm);
+  // there is something to write now
+  kick_dispatcher();
+
+  UNICOMM_DEBUG_OUT(
+    "[unicomm::communicator]: RAW DATA IS PUSHED TO QUEUE; comm ID = " 
+    << dec << id() << "; message ID = " << mid << "; data SIZE = " 
+    << (data? lexical_cast<string>(data->size()): string("<stream>")))
+
+  return mid;
+}
+
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::communicator::prepare_to_write(const message_base &message, 
+                                        shared_out_buffer_type& out_buffer)
 {
   // fixme: const_cast, how to avoid?
   message_base& m = const_cast<message_base&>(message);
@@ -1194,7 +1251,10 @@ unicomm::communicator::prepare_to_write(const message_base &message)
   // set message id
   messageid_type mid = get_id(m);//undefined_messageid();
 
-  const unicomm::config& conf = config();
+  const unicomm::config& conf    = config();
+  // resolved once, the policies are looked up by the type further
+  const message_typeid_type type = conf.message_type(m);
+
   // adjust message id and priority only if timeouts enabled
   if (use_unique_message_id(conf) && !id_exists(m))
   {
@@ -1206,16 +1266,29 @@ unicomm::communicator::prepare_to_write(const message_base &message)
   if (conf.use_default_message_priority() && 
     is_undefined_priority(get_priority(m)))
   {
-    set_priority(m, conf.message_priority(get_name(m)));
+    set_priority(m, conf.message_priority(type));
+  }
+
+  // the message is encoded once if it's broadcast and the encoder 
+  // doesn't depend on the session, id and priority are already set then 
+  // by the first communicator, so they are the same
+  message_encoder_base& encoder  = conf.message_encoder();
+  shared_out_buffer_type encoded = out_buffer;
+  if (!encoded)
+  {
+    encoded.reset(new out_buffer_type(encoder.perform_encode(m, session())));
+    if (!encoder.session_dependent())
+    {
+      out_buffer = encoded;
+    }
   }
 
-  //const out_buffer_type& out_buffer = 
-  //  conf.message_encoder().perform_encode(m, session());
-  const out_buffer_type out_buffer = 
-    conf.message_encoder().perform_encode(m, session());
+  prepeared_message pm(mid, type, get_priority(m), encoded);
+  pm.encode_header(encoder, session());
 
-  push_prepeared_message(
-    prepeared_message(mid, get_name(m), get_priority(m), out_buffer));
+  push_prepeared_message(pm);
+  // there is something to write now
+  kick_dispatcher();
 
   UNICOMM_DEBUG_OUT(
     "[unicomm::communicator]: MESSAGE IS PUSHED TO QUEUE; comm ID = " 
@@ -1254,14 +1327,24 @@ unicomm::communicator::prepare_to_write(const message_base &message)
 //-----------------------------------------------------------------------------
 void unicomm::communicator::mt_start_read(void)
 {
-  local_buffer_ptr_type buf_ptr(new local_buffer_type());
-  //buf_ptr->assign(0);
+#ifdef UNICOMM_LAZY_RECEIVE_BUFFER
+
+  // wait for the data with no buffer, the buffer is taken by the handler
+  _socket.async_read_some(boost::asio::null_buffers(),  
+    _strand.wrap(boost::bind(&communicator::mt_asio_readable_handler, 
+      shared_from_this(), boost::asio::placeholders::error)));
+
+#else // UNICOMM_LAZY_RECEIVE_BUFFER
 
-  _socket.async_read_some(boost::asio::buffer(buf_ptr->c_array(), 
-    local_buffer_type::static_size), 
-    boost::bind(&communicator::mt_asio_read_handler, shared_from_this(),
-      boost::asio::placeholders::error, 
-      boost::asio::placeholders::bytes_transferred, buf_ptr));
+  // returned to the pool by the read handler
+  const receive_buffer_ptr_type buf_ptr = owner().receive_buffers(shard()).acquire();
+
+  _socket.async_read_some(boost::asio::buffer(*buf_ptr),  
+    _strand.wrap(boost::bind(&communicator::mt_asio_read_handler, 
+      shared_from_this(), boost::asio::placeholders::error, 
+      boost::asio::placeholders::bytes_transferred, buf_ptr)));
+
+#endif // UNICOMM_LAZY_RECEIVE_BUFFER
 }
 
 //-----------------------------------------------------------------------------
@@ -1273,84 +1356,191 @@ bool unicomm::communicator::is_prepeared_message_queue_empty(void) const
 //-----------------------------------------------------------------------------
 bool unicomm::communicator::is_ready_to_write(void) const
 {
-  return !is_prepeared_message_queue_empty();
+  // only one write operation can be in progress on the socket
+  return !is_writing() && 
+    (_out_stream.pending_stream() || !is_prepeared_message_queue_empty());
 }
 
 //-----------------------------------------------------------------------------
-void unicomm::communicator::push_prepeared_message(const prepeared_message& m)
+void unicomm::communicator::push_prepeared_message(prepeared_message& m)
 {
   _prepeared_m_queue.push(m);
 }
 
 //-----------------------------------------------------------------------------
-unicomm::communicator::prepeared_message 
-unicomm::communicator::pop_prepeared_message(void)
+void unicomm::communicator::pop_prepeared_message(prepeared_message& m)
+{
+  BOOST_VERIFY(_prepeared_m_queue.pop(m) && " - Outgoing queue is empty");
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::communicator::next_prepeared_message(prepeared_message& m)
+{
+  // the stream being written goes on before anything else
+  if (_out_stream.pending_stream())
+  {
+    m.swap(_out_stream);
+  } else
+  {
+    pop_prepeared_message(m);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::communicator::read_stream_chunk(prepeared_message& m)
 {
-  const prepeared_message m = _prepeared_m_queue.front_copy();
-  // immediately remove the message from the queue
-  _prepeared_m_queue.pop();
+  BOOST_ASSERT(m.pending_stream() && " - There is no stream to be read");
 
-  return m;
+  const message_stream::pointer_type stream = m.stream();
+  boost::shared_ptr<out_buffer_type> chunk(new out_buffer_type);
+
+  stream->read_chunk(*chunk, stream_chunk_size(config()));
+
+  const bool last = chunk->empty() || stream->eof();
+  if (!last)
+  {
+    prepeared_message rest(m.id(), m.type(), m.priority(), 
+      shared_out_buffer_type(), stream);
+
+    // the rest is queued back with its priority if the other messages are 
+    // allowed to go between the chunks, otherwise it's written next
+    if (stream->self_delimited())
+    {
+      push_prepeared_message(rest);
+    } else
+    {
+      _out_stream.swap(rest);
+    }
+  }
+
+  UNICOMM_DEBUG_OUT("[unicomm::communicator]: STREAM CHUNK IS READ; comm ID = " 
+    << dec << id() << "; message ID = " << m.id() << "; chunk SIZE = " 
+    << chunk->size() << "; last = " << last)
+
+  // sent notification is issued by the last chunk
+  prepeared_message(m.id(), m.type(), m.priority(), 
+    shared_out_buffer_type(chunk), stream, !last).swap(m);
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::communicator::mt_start_write(void)
 {
-  for (const smart::timeout tout(milliseconds(config().outgoing_quantum()));
-    is_ready_to_write() && !tout.elapsed(); )
+  BOOST_ASSERT(is_ready_to_write() && 
+    " - Write operation is in progress or there is nothing to write");
+
+  BOOST_ASSERT(_write_batch.empty() && " - Previous write batch isn't released");
+
+  const unicomm::config& conf = config();
+  const size_t max_messages   = std::max(conf.outgoing_batch_messages(), size_t(1));
+  const size_t max_bytes      = conf.outgoing_batch_bytes();
+
+  // gather queued messages into a single write, the next batch is written 
+  // when this one is completed, overlapped writes would interleave 
+  // the data on the socket
+  out_buffers_sequence_type buffers;
+  size_t bytes = 0;
+
+  do
   {
-    // start writing
-    const prepeared_message m = pop_prepeared_message();
+    prepeared_message m;
+
+    next_prepeared_message(m);
 
-    BOOST_ASSERT((!use_unique_message_id(config()) || 
+    if (m.pending_stream())
+    {
+      // a chunk is written by a batch of its own, so the memory held 
+      // is bounded and a stream failure doesn't affect the other messages
+      if (!_write_batch.empty())
+      {
+        _out_stream.swap(m);
+        break;
+      }
+
+      read_stream_chunk(m);
+    }
+
+    BOOST_ASSERT((!use_unique_message_id(conf) || 
       m.id() != undefined_messageid()) && 
       " - Message identifier is undefined. Shouldn't have been.");
-    BOOST_ASSERT((!config().use_default_message_priority() || 
+    BOOST_ASSERT((!conf.use_default_message_priority() || 
       m.priority() != undefined_priority()) && 
       " - Message priority is undefined. Shouldn't have been.");
 
-    // put message into outgoing buffers
-    const messageid_type int_mid = mt_out_buffers_insert(m);
-    const string& s              = mt_get_out_buffers_item(int_mid).out_buffer();
+    // register outgoing messages id and its timeout before the data reaches 
+    // the peer, the reply could be handled before the write completion is
+    if (conf.timeouts_enabled() && conf.need_reply(m.type()))
+    {
+      reg_message_timeout(m.id(), m.type());
+    }
 
-    BOOST_ASSERT(!s.empty() && " - Output buffer can't be empty");
-    // start asio async write
-    boost::asio::async_write(_socket, boost::asio::buffer(s),
-      boost::bind(&communicator::mt_asio_write_handler, shared_from_this(), 
-      boost::asio::placeholders::error, int_mid));
-  }
+    // put message into outgoing buffers, map nodes are stable, 
+    // so the data stays in place until the write completes, 
+    // m is empty after this
+    const messageid_type int_mid   = out_buffers_insert(m);
+    const prepeared_message& item  = get_out_buffers_item(int_mid);
+    const string& s                = item.out_buffer();
+
+    BOOST_ASSERT((!s.empty() || item.stream()) && 
+      " - Output buffer can't be empty");
+
+    _write_batch.push_back(int_mid);
+    if (item.header_len() != 0)
+    {
+      buffers.push_back(boost::asio::buffer(item.header(), item.header_len()));
+      bytes += item.header_len();
+    }
+    buffers.push_back(boost::asio::buffer(s));
+    bytes += s.size();
+
+    if (item.stream())
+    {
+      break;
+    }
+  } while (_write_batch.size() < max_messages && 
+    (max_bytes == 0 || bytes < max_bytes) && 
+    !is_prepeared_message_queue_empty());
+
+  UNICOMM_DEBUG_OUT("[unicomm::communicator]: Write batch started; comm ID = " 
+    << std::dec << id() << "; messages = " << _write_batch.size() 
+    << "; bytes = " << bytes)
+
+  // start asio async write
+  boost::asio::async_write(_socket, buffers,
+    _strand.wrap(boost::bind(&communicator::mt_asio_write_handler, 
+      shared_from_this(), boost::asio::placeholders::error)));
 }
 
 //////////////////////////////////////////////////////////////////////////
 // boost asio handlers
 void unicomm::communicator::mt_asio_read_handler(
   const boost::system::error_code& error, 
-  size_t n, const local_buffer_ptr_type& buf_ptr)
+  size_t n, const receive_buffer_ptr_type& buf_ptr)
 {
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: Async read completed invoked; comm ID = " 
     << std::dec << id())
 
-  // read error mutex
-  mutex_type::scoped_lock lock(_read_err_mutex);
-
   _read_error = error;
   if (error)
   {
     UNICOMM_DEBUG_OUT("[unicomm::communicator]: Read channel error; comm ID = " 
       << std::dec << id() << "; [" << error << "; " << error.message() << "]")
+
+    // there is no buffer if the wait for data has failed
+    if (buf_ptr)
+    {
+      owner().receive_buffers(shard()).release(buf_ptr);
+    }
   } else
   {
-    // in buffer mutex
-    //in_buffer_mutex_type::scoped_lock lock(_in_buf_mutex);
-
     // at first, start next read operation anyway
     generic_scoped_sentinel sentry(boost::bind(&communicator::mt_start_read, this));
     // get data
     BOOST_ASSERT(n <= buf_ptr->size() && " - Buffer overrun detected");
 
-    _in_buffer.append(string(buf_ptr->begin(), 
-      buf_ptr->begin() + std::min(n, buf_ptr->size())));
+    _in_buffer.append(&(*buf_ptr)[0], std::min(n, buf_ptr->size()));
     mt_is_in_buffer_updated(true);
+    // data is copied, let the next read reuse the buffer
+    owner().receive_buffers(shard()).release(buf_ptr);
   }
 
   // tell to process either error or incoming data
@@ -1360,32 +1550,77 @@ void unicomm::communicator::mt_asio_read_handler(
     << "comm ID = " << std::dec << id())
 }
 
+#ifdef UNICOMM_LAZY_RECEIVE_BUFFER
+
+//-----------------------------------------------------------------------------
+void unicomm::communicator::mt_asio_readable_handler(
+  const boost::system::error_code& error)
+{
+  if (error)
+  {
+    mt_asio_read_handler(error, 0, receive_buffer_ptr_type());
+    return;
+  }
+
+  error_code read_error;
+
+  // the readiness may be spurious, the read mustn't block then
+  if (!_socket.non_blocking())
+  {
+    _socket.non_blocking(true, read_error);
+  }
+
+  // returned to the pool by the read handler
+  const receive_buffer_ptr_type buf_ptr = owner().receive_buffers(shard()).acquire();
+  const size_t n = read_error? 0: _socket.read_some(boost::asio::buffer(*buf_ptr), read_error);
+
+  if (read_error == boost::asio::error::would_block || 
+    read_error == boost::asio::error::try_again)
+  {
+    owner().receive_buffers(shard()).release(buf_ptr);
+    mt_start_read();
+    return;
+  }
+
+  // the buffer is returned to the pool by the read handler either way
+  mt_asio_read_handler(read_error, n, buf_ptr);
+}
+
+#endif // UNICOMM_LAZY_RECEIVE_BUFFER
+
 //-----------------------------------------------------------------------------
 void unicomm::communicator::mt_asio_write_handler(
-  const boost::system::error_code& error, 
-  messageid_type int_mid)
+  const boost::system::error_code& error)
 {
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: Async write completed invoked; " 
     << "comm ID = " << std::dec << id())
 
-  // write error mutex
-  mutex_type::scoped_lock lock(_write_err_mutex);
-
   _write_error = error;
   if (error)
   {
     UNICOMM_DEBUG_OUT("[unicomm::communicator]: Write channel error; comm ID = " 
       << std::dec << id() << "; [" << error << "; " << error.message() << "]")
-    // tell to process
-    kick_dispatcher();
-  } else
+  }
+
+  for (out_buffers_ids_type::const_iterator it = _write_batch.begin(); 
+    it != _write_batch.end(); ++it)
   {
-    // push message id into messages sent collection on success
-    mt_reg_sent_message(int_mid);
+    // push message id into messages sent collection on success, 
+    // the whole batch is either written or failed
+    if (!error && !get_out_buffers_item(*it).partial())
+    {
+      reg_sent_message(*it);
+    }
+
+    // anyway erase out buffer, doesn't throw
+    out_buffers_erase(*it);
   }
 
-  // anyway erase out buffer, doesn't throw
-  mt_out_buffers_erase(int_mid);
+  // keep the capacity for the next batch
+  _write_batch.clear();
+
+  // tell to process either error or sent message
+  kick_dispatcher();
 
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: Async write completed finished; "
     << "comm ID = " << std::dec << id())
@@ -1438,6 +1673,9 @@ void unicomm::communicator::handle_handshake(const boost::system::error_code& er
     just_connected(true);
   }
 
+  // tell to process either error or connect
+  kick_dispatcher();
+
   UNICOMM_DEBUG_OUT("[unicomm::communicator]: SSL Handshake handler finished; comm ID = " 
     << std::dec << id() << "; [" << error << "; " << error.message() << "]")
 }
@@ -1494,13 +1732,31 @@ bool unicomm::communicator::mt_is_in_buffer_empty(void) const
 //-----------------------------------------------------------------------------
 unicomm::message_base::pointer_type unicomm::communicator::mt_perform_decode(void)
 {
-  return config().message_decoder().perform_decode(_in_buffer, session());
-}
+  try
+  {
+    message_base::pointer_type m = 
+      config().message_decoder().perform_decode(_in_buffer, session());
+
+    // whatever is buffered is an incomplete message, the decoder limiting 
+    // the length by itself knows the framing, so it's not checked here
+    if (!m && config().max_message_length() != 0 && 
+      !config().message_decoder().limits_message_length() && 
+      _in_buffer.size() > config().max_message_length())
+    {
+      throw message_too_long_error("Incoming message is too long [Limit: " + 
+        lexical_cast<string>(config().max_message_length()) + "]");
+    }
 
-//-----------------------------------------------------------------------------
-inline bool unicomm::communicator::mt_is_sent_messages_empty(void) const
-{
-  mutex_type::scoped_lock lock(_sent_mes_mutex);
+    return m;
+  }
+  catch (const message_too_long_error&)
+  {
+    // the message is dropped with the connection, so it's not decoded 
+    // and reported again by the next pass
+    _in_buffer.clear();
+    mt_is_in_buffer_updated(false);
 
-  return is_sent_messages_empty();
+    throw;
+  }
 }
+
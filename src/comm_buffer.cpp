@@ -13,15 +13,92 @@
 
 #include <unicomm/comm_buffer.hpp>
 
-using boost::mutex;
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using std::string;
+using unicomm::detail::spin_mutex;
+
+//////////////////////////////////////////////////////////////////////////
+// buffer_view
+unicomm::buffer_view::size_type 
+unicomm::buffer_view::find(char c, size_type pos) const
+{
+  if (pos >= size())
+  {
+    return string::npos;
+  }
+
+  const void* p = std::memchr(_begin + pos, c, size() - pos);
+
+  return p == 0? string::npos: static_cast<const char*>(p) - _begin;
+}
+
+//------------------------------------------------------------------------
+unicomm::buffer_view::size_type 
+unicomm::buffer_view::find(const string& s, size_type pos) const
+{
+  if (s.empty())
+  {
+    return pos <= size()? pos: string::npos;
+  }
+
+  // look for the first character and compare the rest then
+  for (; pos + s.size() <= size(); ++pos)
+  {
+    if ((pos = find(s[0], pos)) == string::npos || pos + s.size() > size())
+    {
+      break;
+    }
+
+    if (std::memcmp(_begin + pos + 1, s.data() + 1, s.size() - 1) == 0)
+    {
+      return pos;
+    }
+  }
+
+  return string::npos;
+}
+
+//------------------------------------------------------------------------
+string unicomm::buffer_view::substr(size_type pos, size_type n) const
+{
+  BOOST_ASSERT(pos <= size() && " - Position is out of range");
+
+  return string(_begin + pos, _begin + pos + std::min(n, size() - pos));
+}
 
 //////////////////////////////////////////////////////////////////////////
 // comm_buffer
 unicomm::comm_buffer& unicomm::comm_buffer::append(const buffer_type& tail)
 {
-  mutex::scoped_lock lock(mutex()); 
-  
-  inner_buffer().append(tail);
+  return append(tail.data(), tail.size());
+}
+
+//------------------------------------------------------------------------
+unicomm::comm_buffer& unicomm::comm_buffer::append(const char* data, size_t n)
+{
+  spin_mutex::scoped_lock lock(mutex()); 
+
+  // reuse the space taken by the consumed data instead of growing
+  if (_head != 0 && _buffer.size() + n > _buffer.capacity())
+  {
+    compact();
+  }
+
+  _buffer.append(data, n);
+
+  return *this;
+}
+
+//------------------------------------------------------------------------
+unicomm::comm_buffer& unicomm::comm_buffer::consume(size_t n)
+{
+  spin_mutex::scoped_lock lock(mutex()); 
+
+  inner_consume(n);
 
   return *this;
 }
@@ -29,9 +106,11 @@ unicomm::comm_buffer& unicomm::comm_buffer::append(const buffer_type& tail)
 //------------------------------------------------------------------------
 unicomm::comm_buffer& unicomm::comm_buffer::swap(buffer_type& other)
 {
-  mutex::scoped_lock lock(mutex()); 
+  spin_mutex::scoped_lock lock(mutex()); 
 
-  inner_buffer().swap(other);
+  compact();
+  _buffer.swap(other);
+  _scanned = 0;
 
   return *this;
 }
@@ -39,9 +118,11 @@ unicomm::comm_buffer& unicomm::comm_buffer::swap(buffer_type& other)
 //------------------------------------------------------------------------
 unicomm::comm_buffer& unicomm::comm_buffer::clear(void)
 {
-  mutex::scoped_lock lock(mutex()); 
+  spin_mutex::scoped_lock lock(mutex()); 
 
-  inner_buffer().clear();
+  _buffer.clear();
+  _head = 0;
+  _scanned = 0;
 
   return *this;
 }
@@ -49,15 +130,80 @@ unicomm::comm_buffer& unicomm::comm_buffer::clear(void)
 //------------------------------------------------------------------------
 bool unicomm::comm_buffer::empty(void) const
 {
-  mutex::scoped_lock lock(mutex()); 
+  spin_mutex::scoped_lock lock(mutex()); 
+
+  return inner_size() == 0;
+}
+
+//------------------------------------------------------------------------
+size_t unicomm::comm_buffer::size(void) const
+{
+  spin_mutex::scoped_lock lock(mutex()); 
 
-  return inner_buffer().empty();
+  return inner_size();
 }
 
 //------------------------------------------------------------------------
 unicomm::comm_buffer::buffer_type unicomm::comm_buffer::data(void) const
 { 
-  mutex::scoped_lock lock(mutex()); 
+  spin_mutex::scoped_lock lock(mutex()); 
+
+  return _buffer.substr(_head); 
+}
+
+//------------------------------------------------------------------------
+unicomm::comm_buffer::buffer_type& unicomm::comm_buffer::compacted_buffer(void)
+{
+  compact();
+  // the data may be changed by the caller
+  _scanned = 0;
+
+  return _buffer;
+}
+
+//------------------------------------------------------------------------
+unicomm::comm_buffer::view_type unicomm::comm_buffer::inner_view(void) const
+{
+  const char* const p = _buffer.data();
 
-  return inner_buffer(); 
-}
\ No newline at end of file
+  return view_type(p + _head, p + _buffer.size(), _scanned);
+}
+
+//------------------------------------------------------------------------
+void unicomm::comm_buffer::inner_consume(size_t n)
+{
+  BOOST_ASSERT(n <= inner_size() && " - Can't consume more than buffered");
+
+  _head += std::min(n, inner_size());
+  // the rest is to be scanned from the beginning
+  _scanned = 0;
+
+  if (_head == _buffer.size())
+  {
+    // everything is consumed, keeps the capacity
+    _buffer.clear();
+    _head = 0;
+  } else if (_head > inner_size())
+  {
+    // the consumed part outweighs the rest, so moving the rest is cheap enough
+    compact();
+  }
+}
+
+//------------------------------------------------------------------------
+void unicomm::comm_buffer::inner_scanned(size_t n)
+{
+  BOOST_ASSERT(n <= inner_size() && " - Can't scan more than buffered");
+
+  _scanned = std::min(n, inner_size());
+}
+
+//------------------------------------------------------------------------
+void unicomm::comm_buffer::compact(void)
+{
+  if (_head != 0)
+  {
+    _buffer.erase(0, _head);
+    _head = 0;
+  }
+}
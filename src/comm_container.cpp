@@ -69,7 +69,7 @@ private:
     const unicomm::comm_container::comm_collection_type::value_type &commpair, 
     const unicomm::message_base& message)
   {
-    return commpair.second->send(message);
+    return commpair.second->send_broadcast(message, _out_buffer);
   }
 
   //-----------------------------------------------------------------------------
@@ -78,13 +78,15 @@ private:
     const unicomm::message_base& message, 
     const unicomm::message_sent_handler_type& handler)
   {
-    return commpair.second->send(message, handler);
+    return commpair.second->send_broadcast(message, _out_buffer, handler);
   }
 
 private:
   //////////////////////////////////////////////////////////////////////////
   // data
   unicomm::full_messageid_map_type _sended;
+  // encoded once and shared by every communicator
+  unicomm::shared_out_buffer_type _out_buffer;
 };
 
 } // unnamed namespace
@@ -187,6 +189,21 @@ void unicomm::comm_container::insert(const comm_ptr& comm)
   }
 }
 
+//------------------------------------------------------------------------
+void unicomm::comm_container::insert(const comm_sequence_type& comms)
+{
+  recursive_mutex::scoped_lock lock(_clients_mutex);
+
+  for (comm_sequence_type::const_iterator cit = comms.begin(); 
+    cit != comms.end(); ++cit)
+  {
+    if (!client_exists((*cit)->id()))
+    {
+      insert_client(*cit, clients());
+    }
+  }
+}
+
 //------------------------------------------------------------------------
 unicomm::full_messageid_map_type 
 unicomm::comm_container::send_all(const unicomm::message_base& message) const
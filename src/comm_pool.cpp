@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////
+// comm_pool.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Pool of the communicator objects reused by the connections.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/comm_pool.hpp>
+#include <unicomm/comm.hpp>
+#include <unicomm/detail/pool_detail.hpp>
+
+#include <smart/debug_out.hpp>
+
+#include <boost/assert.hpp>
+
+//////////////////////////////////////////////////////////////////////////
+// shard pool
+class unicomm::comm_pool::shard_pool : private boost::noncopyable
+{
+public:
+  explicit shard_pool(size_t max_idle): _idle(max_idle) { /* empty */ }
+
+  ~shard_pool(void)
+  {
+    close();
+  }
+
+public:
+  communicator* acquire(void)
+  {
+    communicator* comm = 0;
+
+    return _idle.acquire(comm)? comm: 0;
+  }
+
+  void release(communicator* comm)
+  {
+    // nobody refers to the object, so it's reset outside the lock
+    if (!_idle.full() && recycle(comm) && _idle.release(comm))
+    {
+      return;
+    }
+
+    delete comm;
+  }
+
+  void reserve(const creator_type& creator)
+  {
+    while (_idle.idle_count() < _idle.max_idle())
+    {
+      // create outside the lock
+      communicator* comm = creator();
+
+      if (!_idle.release(comm))
+      {
+        delete comm;
+        break;
+      }
+    }
+  }
+
+  // frees idle objects, the ones released later are freed at once
+  void close(void)
+  {
+    communicators_type idle;
+
+    _idle.close(idle);
+
+    for (communicators_type::const_iterator cit = idle.begin();
+      cit != idle.end(); ++cit)
+    {
+      delete *cit;
+    }
+  }
+
+  void created(void) { _idle.created(); }
+
+  size_t idle_count(void) const { return _idle.idle_count(); }
+  size_t hits(void) const { return _idle.hits(); }
+  size_t misses(void) const { return _idle.misses(); }
+
+private:
+  typedef detail::idle_list<communicator*> idle_list_type;
+  typedef idle_list_type::objects_type communicators_type;
+
+private:
+  static bool recycle(communicator* comm)
+  {
+    try
+    {
+      comm->recycle();
+    }
+    catch (const std::exception& UNICOMM_IFDEF_DEBUG(e))
+    {
+      UNICOMM_DEBUG_OUT("[unicomm::comm_pool]: Communicator recycling has risen "
+        << "an std::exception; comm ID = " << std::dec << comm->id()
+        << "; what [" << e.what() << "]")
+
+      return false;
+    }
+
+    return true;
+  }
+
+private:
+  idle_list_type _idle;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// communicator pool
+unicomm::comm_pool::comm_pool(size_t shards, size_t max_idle):
+  _max_idle(max_idle)
+{
+  BOOST_ASSERT(max_idle > 0 && " - Pool should hold at least one object");
+
+  _pools.reserve(shards);
+  for (size_t i = 0; i < shards; ++i)
+  {
+    _pools.push_back(shard_pool_ptr(new shard_pool(max_idle)));
+  }
+}
+
+//-----------------------------------------------------------------------------
+unicomm::comm_pool::~comm_pool(void)
+{
+  // the io services the idle objects are bound to are about to be destroyed
+  for (shard_pools_type::const_iterator cit = _pools.begin();
+    cit != _pools.end(); ++cit)
+  {
+    (*cit)->close();
+  }
+}
+
+//-----------------------------------------------------------------------------
+unicomm::comm_pointer_type
+unicomm::comm_pool::acquire(size_t shard, const creator_type& creator)
+{
+  BOOST_ASSERT(shard < _pools.size() && " - Invalid io service index");
+
+  const shard_pool_ptr& pool = _pools[shard];
+
+  communicator* comm = pool->acquire();
+  if (!comm)
+  {
+    // create outside the lock
+    comm = creator();
+    pool->created();
+  }
+
+  // every lending gets a reference counter of its own, so the object
+  // returns to the pool as soon as the handlers of the connection release it
+  return detail::lend(comm, pool, comm);
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::comm_pool::reserve(size_t shard, const creator_type& creator)
+{
+  BOOST_ASSERT(shard < _pools.size() && " - Invalid io service index");
+
+  _pools[shard]->reserve(creator);
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::comm_pool::idle_count(size_t shard) const
+{
+  return shard < _pools.size()? _pools[shard]->idle_count(): 0;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::comm_pool::hits(void) const
+{
+  size_t n = 0;
+
+  for (shard_pools_type::const_iterator cit = _pools.begin(); cit != _pools.end(); ++cit)
+  {
+    n += (*cit)->hits();
+  }
+
+  return n;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::comm_pool::misses(void) const
+{
+  size_t n = 0;
+
+  for (shard_pools_type::const_iterator cit = _pools.begin(); cit != _pools.end(); ++cit)
+  {
+    n += (*cit)->misses();
+  }
+
+  return n;
+}
@@ -15,6 +15,8 @@
 #include <unicomm/except.hpp>
 #include <unicomm/facade/bin_message_decoder.hpp>
 #include <unicomm/facade/bin_message_encoder.hpp>
+#include <unicomm/facade/bin_lp_message_decoder.hpp>
+#include <unicomm/facade/bin_lp_message_encoder.hpp>
 #include <detail/basic_detail.hpp>
 
 #include <smart/debug_out.hpp>
@@ -54,6 +56,18 @@ bool unicomm::is_allowed_reply(const config& conf,
       allowed_answers.end();
 }
 
+//-----------------------------------------------------------------------------
+bool unicomm::is_allowed_reply(const config& conf, 
+                               message_typeid_type request_type, 
+                               message_typeid_type reply_type)
+{
+  const config::message_types_type& allowed_answers = 
+    conf.message_answer_types(request_type);
+
+  return allowed_answers.empty()? true: 
+    std::binary_search(allowed_answers.begin(), allowed_answers.end(), reply_type);
+}
+
 //-----------------------------------------------------------------------------
 unicomm::config& unicomm::set_binary_message_format(config& conf)
 {
@@ -69,23 +83,61 @@ unicomm::config& unicomm::set_binary_message_format(config& conf)
   return conf;
 }
 
+//-----------------------------------------------------------------------------
+unicomm::config& unicomm::set_binary_lp_message_format(config& conf)
+{
+  conf.message_format(binary_lp_message_format());
+
+  // the length header is trusted up to the limit only
+  const size_t max_length = conf.max_message_length() != 0? 
+    conf.max_message_length(): detail::default_bin_lp_max_length();
+
+  message_decoder_base::pointer_type decoder = 
+    create_binary_lp_decoder(max_length);
+
+  decoder->factory(conf.message_factory());
+
+  conf.message_decoder(decoder);
+  conf.message_encoder(create_binary_lp_encoder());
+
+  return conf;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // interface
 unicomm::config::config(const session_base::factory_type& session_factory, 
                         const message_base::factory_type& message_factory):
   _tcp_port(detail::default_tcp_port()),
   _tcp_backlog(detail::default_tcp_backlog()),
+  _server_acceptors(detail::default_server_acceptors()),
+  _server_pending_accepts(detail::default_server_pending_accepts()),
+  _server_accept_burst(detail::default_server_accept_burst()),
+  _server_ipv6_only(false),
   _def_tout(infinite_timeout()),
   _def_priority(undefined_priority()),
   _timeouts_enabled(false),
   _mes_encoder(detail::default_message_encoder()),
   _session_factory(session_factory),
   _message_factory(message_factory),
+  _max_message_length(detail::default_max_message_length()),
   _use_unique_message_id(false),
   _use_default_message_priority(false),
   _working_th_sleep_tout(detail::default_sleep_timeout()),
+  _dispatcher_idle_process_all(false),
   _incoming_quantum(detail::default_incoming_quantum()),
-  _outgoing_quantum(detail::default_outgoing_quantum())
+  _outgoing_quantum(detail::default_outgoing_quantum()),
+  _dispatcher_pending_kicks(detail::default_pending_kicks()),
+  _dispatcher_io_services(detail::default_io_services()),
+  _dispatcher_least_loaded(false),
+  _dispatcher_pin_threads(false),
+  _receive_buffer_size(detail::default_receive_buffer_size()),
+  _receive_buffer_pool_size(detail::default_receive_buffer_pool_size()),
+  _message_pool_size(detail::default_message_pool_size()),
+  _comm_pool_size(detail::default_comm_pool_size()),
+  _outgoing_batch_messages(detail::default_outgoing_batch_messages()),
+  _outgoing_batch_bytes(detail::default_outgoing_batch_bytes()),
+  _stream_chunk_size(detail::default_stream_chunk_size()),
+  _timeouts_resolution(detail::default_timeouts_resolution())
 { 
   // empty
 }
@@ -103,20 +155,61 @@ unicomm::message_encoder_base& unicomm::config::message_encoder(void) const
 }
 
 //-----------------------------------------------------------------------------
-const unicomm::message_info& unicomm::config::mes_info(const string &mesname) const
+const unicomm::config::message_policy& 
+unicomm::config::mes_policy(message_typeid_type type) const
 {
-  messages_map_type::const_iterator cit = _messages.find(mesname);
-
-  if (cit == _messages.end())
+  if (type >= _message_policies.size() || !_message_policies[type].declared)
   {
-    static const unicomm::message_info info("", false, default_timeout(), 
-      strings_type(), default_priority()); 
+    static const message_policy policy(unicomm::message_info("", false, 
+      default_timeout(), strings_type(), default_priority())); 
 
-    return info;
+    return policy;
   } else
   {
-    return cit->second;
+    return _message_policies[type];
+  }
+}
+
+//-----------------------------------------------------------------------------
+unicomm::message_typeid_type 
+unicomm::config::intern_message_type(const string& name)
+{
+  const message_typeid_type type = register_message_type(name);
+
+  _message_types.insert(make_pair(name, type));
+  if (type >= _message_policies.size())
+  {
+    _message_policies.resize(type + 1);
+  }
+
+  return type;
+}
+
+//-----------------------------------------------------------------------------
+unicomm::message_typeid_type 
+unicomm::config::message_type(const string& mesname) const
+{
+  message_types_map_type::const_iterator cit = _message_types.find(mesname);
+
+  return cit == _message_types.end()? undefined_message_typeid(): cit->second;
+}
+
+//-----------------------------------------------------------------------------
+unicomm::message_typeid_type 
+unicomm::config::message_type(const message_base& m) const
+{
+  message_typeid_type type = m.type_id();
+
+  if (type == undefined_message_typeid())
+  {
+    type = message_type(get_name(m));
+    if (type != undefined_message_typeid())
+    {
+      m.type_id(type);
+    }
   }
+
+  return type;
 }
 
 //-----------------------------------------------------------------------------
@@ -191,7 +284,29 @@ unicomm::config& unicomm::config::home_dir(const string& dir)
 //-----------------------------------------------------------------------------
 unicomm::config& unicomm::config::message_info(const unicomm::message_info& info)
 {
-  _messages.insert(make_pair(info.name(), info)); return *this;
+  const message_typeid_type type = intern_message_type(info.name());
+
+  // message declared twice keeps the first information
+  if (!_message_policies[type].declared)
+  {
+    message_types_type answers;
+
+    const strings_type& names = info.answers();
+    for (strings_type::const_iterator cit = names.begin(); cit != names.end(); ++cit)
+    {
+      answers.push_back(intern_message_type(*cit));
+    }
+
+    std::sort(answers.begin(), answers.end());
+
+    message_policy& policy = _message_policies[type];
+
+    policy.declared = true;
+    policy.info     = info;
+    policy.answers.swap(answers);
+  }
+
+  return *this;
 }
 
 //-----------------------------------------------------------------------------
@@ -237,6 +352,19 @@ unicomm::config::message_factory(const message_base::factory_type& factory)
   return *this;
 }
 
+//-----------------------------------------------------------------------------
+unicomm::config& unicomm::config::message_pool_size(size_t n)
+{
+  _message_pool_size = n;
+
+  if (message_decoder_exists())
+  {
+    message_decoder().message_pool_size(_message_pool_size);
+  }
+
+  return *this;
+}
+
 //-----------------------------------------------------------------------------
 unicomm::config& 
 unicomm::config::session_factory(const session_base::factory_type& factory)
@@ -248,7 +376,14 @@ unicomm::config::session_factory(const session_base::factory_type& factory)
 unicomm::config& unicomm::config::message_decoder(
   const message_decoder_base::pointer_type& decoder)
 {
-  _mes_decoder = decoder; return *this;
+  _mes_decoder = decoder;
+
+  if (message_decoder_exists())
+  {
+    message_decoder().message_pool_size(_message_pool_size);
+  }
+
+  return *this;
 }
 
 //-----------------------------------------------------------------------------
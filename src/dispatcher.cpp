@@ -20,6 +20,8 @@
 #include <unicomm/comm.hpp>
 #include <unicomm/detail/helper_detail.hpp>
 
+#include <detail/basic_detail.hpp>
+
 #include <smart/debug_out.hpp>
 #include <smart/scoped_sentinel.hpp>
 #include <smart/utils.hpp>
@@ -36,6 +38,12 @@
 #include <algorithm>
 #include <iostream>
 
+#ifdef UNI_LINUX
+# include <pthread.h>
+# include <sched.h>
+# include <unistd.h>
+#endif // UNI_LINUX
+
 #ifdef UNICOMM_FORK_SUPPORT
 # include <sys/types.h>
 # include <sys/wait.h>
@@ -60,6 +68,7 @@ using boost::asio::ip::tcp;
 using boost::posix_time::time_duration;
 using boost::posix_time::seconds;
 using boost::asio::deadline_timer;
+using boost::asio::steady_timer;
 //using boost::this_thread::get_id;
 
 using smart::generic_scoped_sentinel;
@@ -92,18 +101,37 @@ namespace
 //
 //#endif // UNICOMM_DEBUG
 
+//////////////////////////////////////////////////////////////////////////
+// receive buffers
+size_t receive_buffer_size(const unicomm::config& conf)
+{
+  return conf.receive_buffer_size() == 0? 
+    unicomm::detail::default_receive_buffer_size(): conf.receive_buffer_size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// message timeouts
+size_t timeouts_resolution(const unicomm::config& conf)
+{
+  return conf.timeouts_resolution() == 0? 
+    unicomm::detail::default_timeouts_resolution(): conf.timeouts_resolution();
+}
+
 } // unnamed namespace
 
 //////////////////////////////////////////////////////////////////////////
 // unicomm dispatcher
 unicomm::dispatcher::dispatcher(const unicomm::config& config):
+  _next_shard(0),
   _endpoint(config.endpoint()),
   _config(config),
   //_wait_on_stop(default_wait_on_stop()),
   _new_commid(0),
   _is_working(true),
   _run_count(0),
-  _kick_count(0)
+  _wheel_armed(false),
+  _message_timeouts(timeouts_resolution(config), 
+    unicomm::detail::timer_wheel_slots())
 {
   constructor();
 }
@@ -111,13 +139,16 @@ unicomm::dispatcher::dispatcher(const unicomm::config& config):
 //-----------------------------------------------------------------------------
 unicomm::dispatcher::dispatcher(const unicomm::config& config, 
                                 const tcp::endpoint &endpoint):
+  _next_shard(0),
   _endpoint(endpoint),
   _config(config),
   //_wait_on_stop(default_wait_on_stop()),
   _new_commid(0),
   _is_working(true),
   _run_count(0),
-  _kick_count(0)
+  _wheel_armed(false),
+  _message_timeouts(timeouts_resolution(config), 
+    unicomm::detail::timer_wheel_slots())
 {
   constructor();
 }
@@ -159,11 +190,8 @@ void unicomm::dispatcher::disconnect_all(void)
 unicomm::messageid_type 
 unicomm::dispatcher::send_one(commid_type commid, const message_base& message) 
 {
-  const messageid_type mid = comm(commid)->send(message);
-  // to make it to be processed as soon as possible by the dispatcher
-  kick_dispatcher();
-
-  return mid;
+  // communicator puts itself into the ready queue
+  return comm(commid)->send(message);
 }
 
 //-----------------------------------------------------------------------------
@@ -171,32 +199,64 @@ unicomm::messageid_type
 unicomm::dispatcher::send_one(commid_type commid, const message_base& message, 
                               const message_sent_handler_type& handler)
 {
-  const messageid_type mid = comm(commid)->send(message, handler);
-  // to make it to be processed as soon as possible by the dispatcher
-  kick_dispatcher();
+  // communicator puts itself into the ready queue
+  return comm(commid)->send(message, handler);
+}
 
-  return mid;
+//-----------------------------------------------------------------------------
+unicomm::messageid_type 
+unicomm::dispatcher::send_raw_one(commid_type commid, 
+                                  const shared_out_buffer_type& data, 
+                                  size_t priority,
+                                  const message_sent_handler_type& handler)
+{
+  // communicator puts itself into the ready queue
+  return comm(commid)->send_raw(data, priority, handler);
 }
 
 //-----------------------------------------------------------------------------
-unicomm::full_messageid_map_type 
-unicomm::dispatcher::send_all(const unicomm::message_base& message) 
+unicomm::messageid_type 
+unicomm::dispatcher::send_stream_one(commid_type commid, 
+                                     const message_stream::pointer_type& stream, 
+                                     size_t priority,
+                                     const message_sent_handler_type& handler)
 {
-  const full_messageid_map_type mids = clients().send_all(message);
-  // to make it to be processed as soon as possible by the dispatcher
-  kick_dispatcher();
+  // communicator puts itself into the ready queue
+  return comm(commid)->send_stream(stream, priority, handler);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::full_messageid_map_type
+unicomm::dispatcher::send_all(const unicomm::message_base& message)
+{
+  full_messageid_map_type mids;
+
+  // communicators put themselves into the ready queue
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    const full_messageid_map_type shard_mids = shard(i).clients().send_all(message);
+
+    mids.insert(shard_mids.begin(), shard_mids.end());
+  }
 
   return mids;
 }
 
 //-----------------------------------------------------------------------------
-unicomm::full_messageid_map_type 
-unicomm::dispatcher::send_all(const message_base& message, 
+unicomm::full_messageid_map_type
+unicomm::dispatcher::send_all(const message_base& message,
                               const message_sent_handler_type& handler)
 {
-  const full_messageid_map_type mids = clients().send_all(message, handler);
-  // to make it to be processed as soon as possible by the dispatcher
-  kick_dispatcher();
+  full_messageid_map_type mids;
+
+  // communicators put themselves into the ready queue
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    const full_messageid_map_type shard_mids =
+      shard(i).clients().send_all(message, handler);
+
+    mids.insert(shard_mids.begin(), shard_mids.end());
+  }
 
   return mids;
 }
@@ -231,7 +291,48 @@ unicomm::dispatcher::commid_collection_type unicomm::dispatcher::connections(voi
 //-----------------------------------------------------------------------------
 size_t unicomm::dispatcher::connections_count(void) const
 {
-  return clients().size();
+  size_t count = 0;
+
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    count += shard(i).clients().size();
+  }
+
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+unicomm::dispatcher_stats unicomm::dispatcher::stats(void) const
+{
+  const message_pool* messages = config().message_decoder().pool();
+
+  size_t kicks_requested = 0;
+  size_t kicks_posted = 0;
+  size_t kicks_handled = 0;
+  size_t buffers_reused = 0;
+  size_t buffers_allocated = 0;
+
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    const shard_type& sh = shard(i);
+
+    kicks_requested += sh.kicks_requested();
+    kicks_posted += sh.kicks_posted();
+    kicks_handled += sh.kicks_handled();
+    buffers_reused += sh.receive_buffers().hits();
+    buffers_allocated += sh.receive_buffers().misses();
+  }
+
+  return dispatcher_stats()
+    .kicks_requested(kicks_requested)
+    .kicks_posted(kicks_posted)
+    .kicks_handled(kicks_handled)
+    .buffers_reused(buffers_reused)
+    .buffers_allocated(buffers_allocated)
+    .messages_reused(messages? messages->hits(): 0)
+    .messages_created(messages? messages->misses(): 0)
+    .comms_reused(_comm_pool? _comm_pool->hits(): 0)
+    .comms_created(_comm_pool? _comm_pool->misses(): 0);
 }
 
 //-----------------------------------------------------------------------------
@@ -258,21 +359,30 @@ const unicomm::config& unicomm::dispatcher::config(void) const
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::fork_prepare(void)
 {
-  ioservice().notify_fork(boost::asio::io_service::fork_prepare);
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).ioservice().notify_fork(boost::asio::io_service::fork_prepare);
+  }
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::fork_parent(void)
 {
-  ioservice().notify_fork(boost::asio::io_service::fork_parent);
-  
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).ioservice().notify_fork(boost::asio::io_service::fork_parent);
+  }
+
   actually_fork_support_all();
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::fork_child(void)
 {
-  ioservice().notify_fork(boost::asio::io_service::fork_child);
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).ioservice().notify_fork(boost::asio::io_service::fork_child);
+  }
 }
 
 #endif // UNICOMM_FORK_SUPPORT
@@ -334,6 +444,7 @@ void unicomm::dispatcher::finalize(void)
   UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Finalizing...")
 
   clear_clients();
+  clear_ready_comms();
   destroy_timer();
 
 #ifdef UNICOMM_FORK_SUPPORT
@@ -357,15 +468,26 @@ void unicomm::dispatcher::finalize(void)
 //-----------------------------------------------------------------------------
 bool unicomm::dispatcher::is_clients_empty(void) const
 {
-  return clients().empty();
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    if (!shard(i).clients().empty())
+    {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::clear_clients(void)
 {
-  if (!clients().empty())
+  for (size_t i = 0; i < shards_count(); ++i)
   {
-    clients().clear();
+    if (!shard(i).clients().empty())
+    {
+      shard(i).clients().clear();
+    }
   }
 }
 
@@ -417,12 +539,12 @@ void unicomm::dispatcher::actually_stop(const time_duration& wait)
 
     //BOOST_ASSERT(clients().empty() && 
     //  " - clients collection should be empty after stop is finished");
-    UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Clients left = " << clients().size())
+    UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Clients left = " << connections_count())
 
     // tell io service to stop working
     destroy_service_work();
     // stop io_service
-    ioservice().stop();
+    stop_io_service();
     // destroy services and clear clients
     if (wait_for_run_finished(wait)) { finalize(); }
   } 
@@ -451,24 +573,71 @@ void unicomm::dispatcher::actually_disconnect_client(commid_type id)
 }
 
 //-----------------------------------------------------------------------------
-void unicomm::dispatcher::process_clients(void)
+void unicomm::dispatcher::process_clients(size_t index)
 {
-  vector<commid_type> comms;
-  comms.reserve(0x80);
+  shard_type& sh = shard(index);
 
-  while (comm_container_type::comm_ptr comm = clients().take_out())
+  // only those are ready at the moment, the rest are processed on next kick
+  comm_ptr comm;
+  for (size_t n = sh.ready_count(); n != 0 && sh.pop_ready(comm); --n)
   {
-    comms.push_back(comm->id());
+    // communicator could have been removed while waiting in the queue, 
+    // it's kept by the shard it's ready on, so the others aren't looked at
+    BOOST_ASSERT(comm->shard() == index && " - Communicator is ready on another shard");
 
-    process_client(*comm);
+    if (sh.clients().exists(comm->id()))
+    {
+      // executed immediately unless a handler of the communicator 
+      // is being executed by another thread
+      comm->strand().dispatch(
+        boost::bind(&dispatcher::process_ready_comm, this, comm));
+    }
   }
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::process_ready_comm(const comm_ptr& comm)
+{
+  const int events = comm->mt_ready_events();
+
+  process_client(*comm);
 
-  // move clients back
-  for_each(comms.begin(), comms.end(), 
-    boost::bind(&comm_container_type::get_back, &clients(), _1));
+  // something has been signaled while processing
+  if (comm->mt_ack_ready(events))
+  {
+    shard(comm->shard()).push_ready(comm);
+    kick_shard(comm->shard());
+  }
+}
 
-  // move all clients back
-  //clients().put_in_all();
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::signal_ready(communicator& comm)
+{
+  if (comm.mt_signal_ready())
+  {
+    shard(comm.shard()).push_ready(comm.shared_from_this());
+  }
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::signal_all_ready(void)
+{
+  const comm_collection_type comms = communicators();
+
+  for (comm_collection_type::const_iterator cit = comms.begin(); 
+    cit != comms.end(); ++cit)
+  {
+    signal_ready(*cit->second);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::clear_ready_comms(void)
+{
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).clear_ready();
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -484,7 +653,7 @@ void unicomm::dispatcher::process_client(communicator& comm)
     // if there is still unprocessed data process it as soon as possible
     if (comm.mt_is_unprocessed_incoming() || comm.mt_is_unprocessed_outgoing()) 
     { 
-      kick_dispatcher();
+      kick_dispatcher(comm);
     }
   } 
   catch (const disconnected_error& e)
@@ -502,6 +671,15 @@ void unicomm::dispatcher::process_client(communicator& comm)
 
     comm.disconnect(); // communicator will be destroyed by disconnected handler
   }
+  catch (const message_too_long_error& e)
+  {
+    UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Message too long error exception; comm ID = " 
+      << comm.id() << " [what: " << e.what() << "]")
+
+    handle_error(comm, e.what()); 
+    // don't buffer the rest of the message
+    comm.disconnect();
+  }
 
 #ifdef UNICOMM_SSL
 
@@ -539,13 +717,19 @@ void unicomm::dispatcher::process_client(communicator& comm)
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::create_service_work(void)
 {
-  _service_work.reset(new service_work_ptr_type::element_type(ioservice()));
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).create_work();
+  }
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::destroy_service_work(void)
 {
-  _service_work.reset();
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).destroy_work();
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -554,6 +738,13 @@ void unicomm::dispatcher::create_timer(void)
   _timer.reset(new deadline_timer(ioservice()));
 
   redeem_timer();
+
+  if (config().timeouts_enabled())
+  {
+    // armed as soon as a timeout is scheduled
+    _wheel_armed = false;
+    _wheel_timer.reset(new steady_timer(ioservice()));
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -571,6 +762,7 @@ void unicomm::dispatcher::redeem_timer(void)
 void unicomm::dispatcher::destroy_timer(void)
 {
   _timer.reset();
+  _wheel_timer.reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -582,26 +774,105 @@ void unicomm::dispatcher::timer_handler(const boost::system::error_code& error)
       << error.message() << "; " << error)
   } else
   {
+    // let every communicator be processed once in a while, if asked to
+    if (config().dispatcher_idle_process_all())
+    {
+      signal_all_ready();
+    }
+
     kick_dispatcher();
     redeem_timer();
   }
 }
 
 //-----------------------------------------------------------------------------
-bool unicomm::dispatcher::remove_client(commid_type id)
+void unicomm::dispatcher::schedule_message_timeout(const comm_ptr& comm, 
+                                                   messageid_type mid, 
+                                                   size_t serial, 
+                                                   size_t tout)
 {
-  const bool ok = clients().erase(id);
+  message_timeouts().schedule(comm, mid, serial, tout);
 
-  UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Client erased; comm ID = " 
-    << id << ", ok = " << ok)
+  if (_wheel_timer && !_wheel_armed.exchange(true))
+  {
+    arm_wheel_timer();
+  }
+}
 
-  return ok;
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::arm_wheel_timer(void)
+{
+  _wheel_timer->expires_from_now(
+    boost::asio::chrono::milliseconds(message_timeouts().resolution()));
+  _wheel_timer->async_wait(
+    boost::bind(&dispatcher::wheel_timer_handler, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::redeem_wheel_timer(void)
+{
+  // scheduled from the previous expiry time, so ticks don't drift
+  _wheel_timer->expires_at(_wheel_timer->expires_at() + 
+    boost::asio::chrono::milliseconds(message_timeouts().resolution()));
+  _wheel_timer->async_wait(
+    boost::bind(&dispatcher::wheel_timer_handler, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::wheel_timer_handler(const boost::system::error_code& error)
+{
+  if (error)
+  {
+    UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Timing wheel timer error: " 
+      << error.message() << "; " << error)
+  } else
+  {
+    timer_wheel::entries_type expired;
+
+    message_timeouts().advance(expired);
+
+    // communicators consider elapsed timeouts through their strands
+    for (timer_wheel::entries_type::const_iterator cit = expired.begin(); 
+      cit != expired.end(); ++cit)
+    {
+      if (const comm_ptr comm = cit->comm())
+      {
+        comm->timeout_elapsed(cit->mid(), cit->serial());
+        kick_dispatcher(*comm);
+      }
+    }
+
+    if (message_timeouts().size() != 0)
+    {
+      redeem_wheel_timer();
+    } else
+    {
+      // disarmed before the check, so a timeout scheduled meanwhile 
+      // either sees the timer disarmed or is seen here
+      _wheel_armed = false;
+
+      if (message_timeouts().size() != 0 && !_wheel_armed.exchange(true))
+      {
+        arm_wheel_timer();
+      }
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
-bool unicomm::dispatcher::client_exists(commid_type id) const
+bool unicomm::dispatcher::remove_client(commid_type id)
 {
-  return clients().exists(id);
+  bool ok = false;
+
+  for (size_t i = 0; i < shards_count() && !ok; ++i)
+  {
+    ok = shard(i).clients().erase(id);
+  }
+
+  UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Client erased; comm ID = " 
+    << id << ", ok = " << ok)
+
+  return ok;
 }
 
 #ifdef UNICOMM_FORK_SUPPORT
@@ -656,7 +927,10 @@ boost::asio::signal_set& unicomm::dispatcher::signal(void) const
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::actually_fork_support_all(void)
 {
-  clients().fork_support_all();
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).clients().fork_support_all();
+  }
 }
 
 #endif // UNICOMM_FORK_SUPPORT
@@ -670,13 +944,138 @@ void unicomm::dispatcher::constructor(void)
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::create_io_service(void)
 {
-  _ioservice.reset(new io_service_ptr_type::element_type);
+  const size_t n = std::max(config().dispatcher_io_services(), size_t(1));
+
+  _shards.clear();
+  for (size_t i = 0; i < n; ++i)
+  {
+    _shards.push_back(shard_ptr_type(new shard_type(
+      receive_buffer_size(config()), config().receive_buffer_pool_size())));
+  }
+
+#ifndef UNICOMM_SSL
+
+  // ssl stream can't be reused by another connection
+  if (config().comm_pool_size() > 0)
+  {
+    _comm_pool.reset(new comm_pool(n, config().comm_pool_size()));
+  }
+
+#endif // UNICOMM_SSL
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::destroy_io_service(void)
 {
-  _ioservice.reset();
+  _comm_pool.reset();
+  _shards.clear();
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::stop_io_service(void)
+{
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).ioservice().stop();
+  }
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::dispatcher::next_shard(void)
+{
+  // a connection bound to the io service no thread runs is never served, 
+  // until any thread calls run() the first one which takes the io service 0
+  const size_t n = shards_count();
+  const size_t first = _next_shard++ % n;
+
+  size_t index = n;
+
+  for (size_t j = 0; j < n; ++j)
+  {
+    const size_t i = (first + j) % n;
+
+    if (shard(i).run_count() == 0)
+    {
+      continue;
+    }
+
+    if (index == n)
+    {
+      index = i;
+
+      if (!config().dispatcher_least_loaded())
+      {
+        break;
+      }
+    } else if (shard(i).clients().size() < shard(index).clients().size())
+    {
+      index = i;
+    }
+  }
+
+  if (index == n)
+  {
+    return 0;
+  }
+
+  if (shard(n - 1).run_count() == 0)
+  {
+    UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: WARNING! There are less threads " 
+      "executing run() than io services, some of them are idle; io services = " << n)
+  }
+
+  return index;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::dispatcher::take_run_shard(void)
+{
+  mutex::scoped_lock lock(_run_shard_mutex);
+
+  // the io services are filled up in order, so the io service 0 
+  // is the first to be run and the last one is the last
+  size_t index = 0;
+
+  for (size_t i = 1; i < shards_count(); ++i)
+  {
+    if (shard(i).run_count() < shard(index).run_count())
+    {
+      index = i;
+    }
+  }
+
+  ++shard(index).run_count();
+
+  return index;
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::pin_run_thread(size_t index) const
+{
+#ifdef UNI_LINUX
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (cpus > 0)
+  {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(index % static_cast<size_t>(cpus), &set);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+      UNICOMM_DEBUG_OUT("[unicomm::dispatcher]: Can't pin the thread to the cpu; io service = " 
+        << index)
+    }
+  }
+
+#else // UNI_LINUX
+
+  // not supported, the system schedules the thread
+  (void)index;
+
+#endif // UNI_LINUX
 }
 
 #ifdef UNICOMM_SSL
@@ -705,38 +1104,136 @@ boost::asio::ssl::context& unicomm::dispatcher::ssl_context(void)
 //-----------------------------------------------------------------------------
 boost::asio::io_service& unicomm::dispatcher::ioservice(void)
 {
-  return *_ioservice;
+  BOOST_ASSERT(shards_count() != 0 && " - Io service should exist");
+
+  return shard(0).ioservice();
+}
+
+//-----------------------------------------------------------------------------
+boost::asio::io_service& unicomm::dispatcher::ioservice(size_t index)
+{
+  BOOST_ASSERT(index < shards_count() && " - Invalid io service index");
+
+  return shard(index).ioservice();
+}
+
+//-----------------------------------------------------------------------------
+unicomm::dispatcher::comm_ptr unicomm::dispatcher::comm(commid_type commid) const
+{
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    if (shard(i).clients().exists(commid))
+    {
+      return shard(i).clients().get(commid);
+    }
+  }
+
+  throw session_not_found("Invalid client identifier has been specified");
+}
+
+//-----------------------------------------------------------------------------
+unicomm::dispatcher::comm_collection_type
+unicomm::dispatcher::communicators(void) const
+{
+  comm_collection_type comms;
+
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    const comm_collection_type shard_comms = shard(i).clients().communicators();
+
+    comms.insert(shard_comms.begin(), shard_comms.end());
+  }
+
+  return comms;
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::insert_comm(const comm_ptr& comm)
 {
-  clients().insert(comm);
+  shard(comm->shard()).clients().insert(comm);
 }
 
-////-----------------------------------------------------------------------------
-//void unicomm::dispatcher::inc_kick_count(void) { ++_kick_count; }
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::insert_comms(const comm_sequence_type& comms)
+{
+  if (shards_count() == 1)
+  {
+    shard(0).clients().insert(comms);
+
+    return;
+  }
+
+  comm_sequence_type shard_comms;
+
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard_comms.clear();
+    for (comm_sequence_type::const_iterator cit = comms.begin(); 
+      cit != comms.end(); ++cit)
+    {
+      if ((*cit)->shard() == i)
+      {
+        shard_comms.push_back(*cit);
+      }
+    }
+
+    if (!shard_comms.empty())
+    {
+      shard(i).clients().insert(shard_comms);
+    }
+  }
+}
 
 //-----------------------------------------------------------------------------
-//void unicomm::dispatcher::dec_kick_count(void) { --_kick_count; }
+int unicomm::dispatcher::kicks_limit(const shard_type& sh) const
+{
+  const size_t limit = config().dispatcher_pending_kicks();
 
-////-----------------------------------------------------------------------------
-//size_t unicomm::dispatcher::kick_count(void) const { return _kick_count; }
+  return detail::use_default_pending_kicks(limit)?
+    sh.run_count(): std::min(sh.run_count(), static_cast<int>(limit));
+}
 
-////-----------------------------------------------------------------------------
-//bool unicomm::dispatcher::can_kick(void) const 
-//{ 
-//  return (_kick_count < int(run_count())? ++_kick_count, true: false);
-//}
+//-----------------------------------------------------------------------------
+bool unicomm::dispatcher::can_kick(shard_type& sh) const
+{
+  // reserve a pending pass unless the limit is reached,
+  // failed exchange reloads the counter
+  const int limit = kicks_limit(sh);
+
+  for (int count = sh.kick_count(); count < limit; )
+  {
+    if (sh.kick_count().compare_exchange_weak(count, count + 1))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
 
 //-----------------------------------------------------------------------------
-void unicomm::dispatcher::kick_dispatcher(void) 
-{ 
-  try 
+void unicomm::dispatcher::kick_dispatcher(void)
+{
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    kick_shard(i);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::kick_shard(size_t index)
+{
+  try
   {
-    if (can_kick())
+    shard_type& sh = shard(index);
+
+    ++sh.kicks_requested();
+
+    if (can_kick(sh))
     {
-      ioservice().post(boost::bind(&dispatcher::kick_handler, this));
+      ++sh.kicks_posted();
+
+      sh.ioservice().post(boost::bind(&dispatcher::kick_handler, this, index));
     }
   } 
   catch (const std::exception& UNICOMM_IFDEF_DEBUG(e))
@@ -753,6 +1250,13 @@ void unicomm::dispatcher::kick_dispatcher(void)
   }
 }
 
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::kick_dispatcher(communicator& comm)
+{
+  signal_ready(comm);
+  kick_shard(comm.shard());
+}
+
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::disconnect_client(communicator& comm)
 {
@@ -765,7 +1269,10 @@ void unicomm::dispatcher::disconnect_client(communicator& comm)
 //-----------------------------------------------------------------------------
 void unicomm::dispatcher::actually_disconnect_all(void)
 {
-  clients().disconnect_all();
+  for (size_t i = 0; i < shards_count(); ++i)
+  {
+    shard(i).clients().disconnect_all();
+  }
 }
 
 ////-----------------------------------------------------------------------------
@@ -960,11 +1467,21 @@ void unicomm::dispatcher::run(void)
     inc_run_count();
     //scoped_sentinel sentry(boost::bind(&dispatcher::dec_run_count, this));
 
+    // threads are assigned to the io services having the fewest threads
+    const size_t index = take_run_shard();
+
+    if (config().dispatcher_pin_threads())
+    {
+      pin_run_thread(index);
+    }
+
     while (is_working())
     {
-      ioservice().run();
+      shard(index).ioservice().run();
     }
 
+    --shard(index).run_count();
+
     if (dec_run_count() == 0)
     {
       signal_run_finished();
@@ -978,7 +1495,7 @@ void unicomm::dispatcher::run(void)
 }
 
 //------------------------------------------------------------------------
-void unicomm::dispatcher::process(void)
+void unicomm::dispatcher::process(size_t index)
 {
 //#ifdef UNICOMM_DEBUG
 //  //debug_out_iteration();
@@ -988,19 +1505,74 @@ void unicomm::dispatcher::process(void)
   // derived extra process
   call_extra_process();
   // process clients
-  process_clients();
+  process_clients(index);
   // post processed callback
   call_after_all_processed();
 }
 
 //------------------------------------------------------------------------
-void unicomm::dispatcher::kick_handler(void)
+void unicomm::dispatcher::kick_handler(size_t index)
+{
+  ++shard(index).kicks_handled();
+
+  SMART_IFDEF_DEBUG(const int count = )--shard(index).kick_count();
+
+  BOOST_ASSERT(count >= 0 && " - Kicks count can't be less then 0 (zero)");
+
+  process(index);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// shard
+void unicomm::dispatcher::shard_type::create_work(void)
+{
+  _work.reset(new work_ptr_type::element_type(_ioservice));
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::shard_type::destroy_work(void)
+{
+  _work.reset();
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::shard_type::push_ready(const comm_ptr& comm)
+{
+  mutex::scoped_lock lock(_ready_mutex);
+
+  _ready_queue.push_back(comm);
+}
+
+//-----------------------------------------------------------------------------
+bool unicomm::dispatcher::shard_type::pop_ready(comm_ptr& comm)
+{
+  mutex::scoped_lock lock(_ready_mutex);
+
+  if (_ready_queue.empty())
+  {
+    return false;
+  }
+
+  comm = _ready_queue.front();
+  _ready_queue.pop_front();
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::dispatcher::shard_type::clear_ready(void)
 {
-  dec_kick_count();
+  mutex::scoped_lock lock(_ready_mutex);
+
+  _ready_queue.clear();
+}
 
-  BOOST_ASSERT(kick_count() >= 0 && " - Kicks count can't be less then 0 (zero)");
+//-----------------------------------------------------------------------------
+size_t unicomm::dispatcher::shard_type::ready_count(void) const
+{
+  mutex::scoped_lock lock(_ready_mutex);
 
-  process();
+  return _ready_queue.size();
 }
 
 //------------------------------------------------------------------------
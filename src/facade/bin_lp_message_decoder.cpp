@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// bin_lp_message_decoder.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Unified Communication protocol length prefixed binary message decoder.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/facade/bin_lp_message_decoder.hpp>
+#include <unicomm/except.hpp>
+#include <detail/basic_detail.hpp>
+
+#include <boost/lexical_cast.hpp>
+
+#include <string>
+
+using std::string;
+using std::make_pair;
+
+using boost::lexical_cast;
+
+//////////////////////////////////////////////////////////////////////////
+// length prefixed binary message decoder
+unicomm::message_decoder_base::iter_pair_type 
+unicomm::bin_lp_message_decoder::find_raw_message(const comm_buffer::view_type& buffer, 
+                                                  session_base& /*session*/)
+{
+  message_decoder_base::iter_pair_type bounds = make_pair(buffer.end(), buffer.end());
+
+  const size_t header_len = detail::bin_lp_header_len();
+
+  if (buffer.size() >= header_len)
+  {
+    const size_t length = detail::bin_lp_read_header(buffer.begin());
+
+    if (length == 0)
+    {
+      throw message_decoder_error("Invalid message format [Zero length]");
+    }
+
+    if (_max_length != 0 && length > _max_length)
+    {
+      throw message_too_long_error("Message is too long [Length: " + 
+        lexical_cast<string>(length) + ", limit: " + 
+        lexical_cast<string>(_max_length) + "]");
+    }
+
+    if (buffer.size() - header_len >= length)
+    {
+      // header is consumed, but not the part of the message
+      bounds.first  = buffer.begin() + header_len;
+      bounds.second = bounds.first + length;
+    }
+  }
+
+  return bounds;
+}
+
@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////////////////
+// bin_lp_message_encoder.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Unified Communication protocol length prefixed binary message encoder.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/facade/bin_lp_message_encoder.hpp>
+#include <detail/basic_detail.hpp>
+
+#include <boost/static_assert.hpp>
+
+#include <stdexcept>
+
+//////////////////////////////////////////////////////////////////////////
+// length prefixed bin message encoder
+size_t unicomm::bin_lp_message_encoder::encode_frame_header(const out_buffer_type& buffer, 
+                                                           char* header, 
+                                                           session_base& /*session*/)
+{
+  BOOST_STATIC_ASSERT(max_frame_header_len >= 4);
+
+  if (buffer.size() > detail::bin_lp_max_len())
+  {
+    throw std::length_error("Message is too long to be encoded");
+  }
+
+  detail::bin_lp_write_header(header, buffer.size());
+
+  return detail::bin_lp_header_len();
+}
+
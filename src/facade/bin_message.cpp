@@ -46,7 +46,8 @@ struct unicomm::bin_message::impl
   impl(size_t p): 
     _id(undefined_messageid()),
     _rid(undefined_messageid()),
-    _priority(p)
+    _priority(p),
+    _initial_priority(p)
   { 
     // empty  
   }
@@ -56,6 +57,7 @@ struct unicomm::bin_message::impl
   messageid_type _id;
   messageid_type _rid;
   size_t _priority;
+  size_t _initial_priority;
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -192,3 +194,11 @@ size_t unicomm::bin_message::priority(void) const
 { 
   return _impl->_priority; 
 }
+
+//-----------------------------------------------------------------------------
+void unicomm::bin_message::reset(void)
+{
+  _impl->_id       = undefined_messageid();
+  _impl->_rid      = undefined_messageid();
+  _impl->_priority = _impl->_initial_priority;
+}
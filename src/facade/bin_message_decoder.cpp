@@ -22,46 +22,103 @@
 #include <boost/bind.hpp>
 
 #include <functional>
+#include <algorithm>
 
 using std::string;
 using std::not_equal_to;
 using std::less;
+using std::make_pair;
 
 //////////////////////////////////////////////////////////////////////////
 // auxiliary
 namespace 
 {
 
-string& binary_decode(string& s)
+// validates the header, the name follows the minimal header
+size_t message_name_length(const string& raw_message)
 {
-  for (string::iterator it = s.begin(); it != s.end(); ++it)
+  using unicomm::message_decoder_error;
+  using unicomm::messageid_type;
+
+  namespace detail = unicomm::detail;
+
+  smart::throw_if<message_decoder_error>(boost::bind(less<size_t>(), 
+    raw_message.size(), detail::bin_header_min_len()), 
+    "Invalid message format [Incomplete header received]");
+
+  // version
+  smart::throw_if<message_decoder_error>(boost::bind(not_equal_to<size_t>(), 
+    raw_message[0], detail::bin_version()), 
+    "Invalid message format [Illegal version]");
+
+  // header length
+  const size_t head_len = raw_message[1];
+
+  smart::throw_if<message_decoder_error>(boost::bind(less<size_t>(), 
+    raw_message.size(), head_len), 
+    "Invalid message format [Incomplete header received]");
+
+  // flags
+  const string::value_type flags = raw_message[2];
+
+  const size_t tmp = detail::is_id_exists(flags) * sizeof(messageid_type) + 
+    detail::is_rid_exists(flags) * sizeof(messageid_type);
+
+  const size_t name_len = head_len - detail::bin_header_min_len() - tmp;
+
+  return std::min(name_len, 
+    raw_message.size() - detail::bin_header_min_len());
+}
+
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// binary unescaping
+string& unicomm::binary_decode(string& s)
+{
+  using unicomm::detail::find_bin_escape_sym;
+
+  if (s.empty())
+  {
+    return s;
+  }
+
+  char* const last = &s[0] + s.size();
+  char* in = find_bin_escape_sym(&s[0], last);
+  // decoded data is never longer, so it's moved towards the beginning in place
+  char* out = in;
+
+  while (in != last)
   {
-    if (unicomm::detail::is_bin_escape_sym(*it))
+    // skip escape symbol
+    if (++in == last)
     {
-      if ((it = s.erase(it)) == s.end())
-      {
-        throw unicomm::message_decoder_error(
-          "Can't decode message [Message is invalid]");
-      }
-
-      *it = unicomm::detail::bin_process_one(*it);
-    } 
+      throw unicomm::message_decoder_error(
+        "Can't decode message [Message is invalid]");
+    }
+
+    *out++ = unicomm::detail::bin_process_one(*in++);
+
+    char* const next = find_bin_escape_sym(in, last);
+    out = std::copy(in, next, out);
+    in  = next;
   }
 
+  s.erase(out - &s[0]);
+
   return s;
 }
 
-} // unnamed namespace
-
 //////////////////////////////////////////////////////////////////////////
 // binary message decoder
 unicomm::message_decoder_base::iter_pair_type 
-unicomm::bin_message_decoder::find_raw_message(comm_buffer::buffer_type& buffer, 
+unicomm::bin_message_decoder::find_raw_message(const comm_buffer::view_type& buffer,  
                                                session_base& /*session*/)
 {
   message_decoder_base::iter_pair_type bounds = make_pair(buffer.end(), buffer.end());
 
-  const string::size_type pos = buffer.find(detail::bin_message_end());
+  const string::size_type pos = 
+    buffer.find(detail::bin_message_end(), buffer.scanned());
   if (pos != string::npos)
   {
     // found something
@@ -72,6 +129,14 @@ unicomm::bin_message_decoder::find_raw_message(comm_buffer::buffer_type& buffer,
   return bounds;
 }
 
+//-----------------------------------------------------------------------------
+size_t unicomm::bin_message_decoder::scanned_length(
+  const comm_buffer::view_type& buffer, session_base& /*session*/)
+{
+  // the marker is one symbol, everything examined doesn't contain it
+  return buffer.size();
+}
+
 //-----------------------------------------------------------------------------
 string& unicomm::bin_message_decoder::decode_raw_message(string& raw_message, 
                                                          session_base& /*session*/)
@@ -88,30 +153,19 @@ string& unicomm::bin_message_decoder::decode_raw_message(string& raw_message,
 string unicomm::bin_message_decoder::get_message_name(const string& raw_message, 
                                                       session_base& /*session*/)
 {
-  smart::throw_if<message_decoder_error>(boost::bind(less<size_t>(), 
-    raw_message.size(), detail::bin_header_min_len()), 
-    "Invalid message format [Incomplete header received]");
-
-  // version
-  smart::throw_if<message_decoder_error>(boost::bind(not_equal_to<size_t>(), 
-    raw_message[0], detail::bin_version()), 
-    "Invalid message format [Illegal version]");
-
-  // header length
-  const size_t head_len = raw_message[1];
-
-  smart::throw_if<message_decoder_error>(boost::bind(less<size_t>(), 
-    raw_message.size(), head_len), 
-    "Invalid message format [Incomplete header received]");
-
-  // flags
-  const string::value_type flags = raw_message[2];
-
-  const size_t tmp = detail::is_id_exists(flags) * sizeof(messageid_type) + 
-    detail::is_rid_exists(flags) * sizeof(messageid_type);
+  return raw_message.substr(detail::bin_header_min_len(), 
+    message_name_length(raw_message));
+}
 
-  const size_t name_len = head_len - detail::bin_header_min_len() - tmp;
+//-----------------------------------------------------------------------------
+unicomm::message_typeid_type 
+unicomm::bin_message_decoder::get_message_type(const string& raw_message, 
+                                               session_base& /*session*/)
+{
+  // the name is looked up right in the raw data
+  const size_t name_len = message_name_length(raw_message);
+  const char* name      = raw_message.data() + detail::bin_header_min_len();
 
-  return raw_message.substr(detail::bin_header_min_len(), name_len);
+  return find_factory_type(name, name + name_len);
 }
 
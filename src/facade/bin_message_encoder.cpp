@@ -19,28 +19,41 @@
 using std::string;
 
 //////////////////////////////////////////////////////////////////////////
-// auxiliary
-namespace 
+// binary escaping
+string& unicomm::binary_encode(string& s)
 {
+  using unicomm::detail::find_bin_special_sym;
 
-string& binary_encode(string& s)
-{
-  for (string::iterator it = s.begin(); it != s.end(); ++it)
+  const char* first = s.data();
+  const char* const last = first + s.size();
+  const char* special = find_bin_special_sym(first, last);
+
+  if (special == last)
   {
-    if (unicomm::detail::is_bin_escape_sym(*it) || 
-      unicomm::detail::is_bin_end_sym(*it))
-    {
-      *it = unicomm::detail::bin_process_one(*it);
-      it  = s.insert(it, unicomm::detail::bin_escape_sym());
-      ++it; // now points to just processed byte
-    }
+    // usual case, nothing to escape
+    return s;
   }
 
+  string out;
+  // escaped symbols are supposed to be rare, reserve for the end marker
+  out.reserve(s.size() + s.size() / 16 + 2);
+
+  do
+  {
+    out.append(first, special);
+    out += unicomm::detail::bin_escape_sym();
+    out += unicomm::detail::bin_process_one(*special);
+
+    first   = special + 1;
+    special = find_bin_special_sym(first, last);
+  } while (special != last);
+
+  out.append(first, last);
+  s.swap(out);
+
   return s;
 }
 
-} // unnamed namespace
-
 //////////////////////////////////////////////////////////////////////////
 // bin message encoder
 unicomm::out_buffer_type& 
@@ -32,6 +32,8 @@ using std::string;
 using std::transform;
 using std::back_inserter;
 
+using boost::asio::ip::tcp;
+
 //////////////////////////////////////////////////////////////////////////
 // aux
 namespace 
@@ -51,6 +53,14 @@ process_hex_str_array(const string_array_type::container_type& array)
   return result;
 }
 
+//-----------------------------------------------------------------------------
+bool is_binary_names(const unicomm::config& conf)
+{
+  // both binary formats use the same messages
+  return unicomm::is_binary_message_format(conf.message_format()) || 
+    unicomm::is_binary_lp_message_format(conf.message_format());
+}
+
 } // unnamed namespace
 
 //////////////////////////////////////////////////////////////////////////
@@ -76,23 +86,70 @@ unicomm::config unicomm::load_from_complex_xml(const std::string& file_name)
   config
     .tcp_port(static_cast<unsigned short>(get_property<uint_type>(c, "tcp_port")))
     .tcp_backlog(read_default(c, "tcp_backlog", int_type(detail::default_tcp_backlog())))
+    .server_acceptors(read_default(c, "server_acceptors", 
+      uint_type(detail::default_server_acceptors())))
+    .server_pending_accepts(read_default(c, "server_pending_accepts", 
+      uint_type(detail::default_server_pending_accepts())))
+    .server_accept_burst(read_default(c, "server_accept_burst", 
+      uint_type(detail::default_server_accept_burst())))
+    .server_ipv6_only(read_default(c, "server_ipv6_only", int_type(0)) != 0)
     .default_timeout(read_default(c, "default_timeout", uint_type(infinite_timeout())))
     .default_priority(read_default(c, "default_priority", uint_type(undefined_priority())))
     .timeouts_enabled(read_default(c, "timeouts_enabled", int_type(0)) != 0)
     .message_format(read_default(c, "message_format", string_type(binary_message_format())))
+    .max_message_length(read_default(c, "max_message_length", 
+      uint_type(detail::default_max_message_length())))
     .home_dir(detail::normalize_path(read_default(c, "home_dir", string_type())))
     .dispatcher_idle_tout(read_default(c, "dispatcher_idle_tout", 
       uint_type(detail::default_sleep_timeout())))
+    .dispatcher_idle_process_all(
+      read_default(c, "dispatcher_idle_process_all", int_type(0)) != 0)
     .incoming_quantum(read_default(c, "incoming_quantum", 
       uint_type(detail::default_incoming_quantum())))
     .outgoing_quantum(read_default(c, "outgoing_quantum", 
       uint_type(detail::default_outgoing_quantum())))
+    .dispatcher_pending_kicks(read_default(c, "dispatcher_pending_kicks", 
+      uint_type(detail::default_pending_kicks())))
+    .dispatcher_io_services(read_default(c, "dispatcher_io_services", 
+      uint_type(detail::default_io_services())))
+    .dispatcher_least_loaded(
+      read_default(c, "dispatcher_least_loaded", int_type(0)) != 0)
+    .dispatcher_pin_threads(
+      read_default(c, "dispatcher_pin_threads", int_type(0)) != 0)
+    .receive_buffer_size(read_default(c, "receive_buffer_size", 
+      uint_type(detail::default_receive_buffer_size())))
+    .receive_buffer_pool_size(read_default(c, "receive_buffer_pool_size", 
+      uint_type(detail::default_receive_buffer_pool_size())))
+    .message_pool_size(read_default(c, "message_pool_size", 
+      uint_type(detail::default_message_pool_size())))
+    .comm_pool_size(read_default(c, "comm_pool_size", 
+      uint_type(detail::default_comm_pool_size())))
+    .outgoing_batch_messages(read_default(c, "outgoing_batch_messages", 
+      uint_type(detail::default_outgoing_batch_messages())))
+    .outgoing_batch_bytes(read_default(c, "outgoing_batch_bytes", 
+      uint_type(detail::default_outgoing_batch_bytes())))
+    .stream_chunk_size(read_default(c, "stream_chunk_size", 
+      uint_type(detail::default_stream_chunk_size())))
+    .timeouts_resolution(read_default(c, "timeouts_resolution", 
+      uint_type(detail::default_timeouts_resolution())))
     .use_unique_message_id(
       read_default(c, "use_unique_message_id", int_type(0)) != 0)
     .use_default_message_priority(
       read_default(c, "use_default_message_priority", int_type(0)) != 0)
   ;
 
+  // every listening address takes the common tcp port
+  const string_array_type listen = 
+    read_default(c, "listen_addresses", string_array_type());
+  const string_array_type::container_type& addresses = listen.inner_array();
+
+  for (string_array_type::container_type::const_iterator cit = addresses.begin();
+    cit != addresses.end(); ++cit)
+  {
+    config.add_listen_endpoint(tcp::endpoint(
+      boost::asio::ip::address::from_string(*cit), config.tcp_port()));
+  }
+
   setup_message_format(config);
 
   //////////////////////////////////////////////////////////////////////////
@@ -105,14 +162,14 @@ unicomm::config unicomm::load_from_complex_xml(const std::string& file_name)
   {
     message_info m_info
       (
-        is_binary_message_format(config.message_format())? 
+        is_binary_names(config)? 
           detail::process_hex_str(get_property<string_type>(*cit, "message_name")): 
           get_property<string_type>(*cit, "message_name"),
 
         read_default(*cit, "need_reply", int_type(0)) != 0,
         read_default(*cit, "timeout", uint_type(config.default_timeout())),
 
-        is_binary_message_format(config.message_format())?
+        is_binary_names(config)?
           process_hex_str_array(read_default(*cit, "answers", 
           string_array_type()).inner_array()):
           read_default(*cit, "answers", string_array_type()).inner_array(),
@@ -177,6 +234,10 @@ unicomm::config& unicomm::setup_message_format(config& conf)
   {
     set_binary_message_format(conf);
   } 
+  else if (is_binary_lp_message_format(conf.message_format()))
+  {
+    set_binary_lp_message_format(conf);
+  }  
   else if (is_xml_message_format(conf.message_format()))
   {
     set_xml_message_format(conf);
@@ -86,11 +86,12 @@ inline bool rid_exists(const smart::data::complex& c)
 // xml message impl
 struct unicomm::xml_message::impl
 {
-  impl(size_t p): _priority(p) { /* empty */ }
+  impl(size_t p): _priority(p), _initial_priority(p) { /* empty */ }
 
   //////////////////////////////////////////////////////////////////////////
   // data
   size_t _priority;
+  size_t _initial_priority;
   smart::data::complex _complex;
 };
 
@@ -155,6 +156,13 @@ size_t unicomm::xml_message::priority(void) const
   return _impl->_priority; 
 }
 
+//-----------------------------------------------------------------------------
+void unicomm::xml_message::reset(void)
+{
+  _impl->_priority = _impl->_initial_priority;
+  _impl->_complex  = smart::data::complex();
+}
+
 //-----------------------------------------------------------------------------
 smart::data::complex& unicomm::xml_message::complex(void) const
 {
@@ -34,13 +34,14 @@ using boost::regex_match;
 //////////////////////////////////////////////////////////////////////////
 // xml message decoder
 unicomm::message_decoder_base::iter_pair_type 
-unicomm::xml_message_decoder::find_raw_message(comm_buffer::buffer_type& buffer, 
+unicomm::xml_message_decoder::find_raw_message(const comm_buffer::view_type& buffer,  
                                                session_base& /*session*/)
 {
   message_decoder_base::iter_pair_type bounds = 
     make_pair(buffer.end(), buffer.end());
 
-  const string::size_type pos = buffer.find(detail::xml_message_end());
+  const string::size_type pos = 
+    buffer.find(detail::xml_message_end(), buffer.scanned());
   if (pos != string::npos)
   {
     // found something
@@ -51,6 +52,16 @@ unicomm::xml_message_decoder::find_raw_message(comm_buffer::buffer_type& buffer,
   return bounds;
 }
 
+//-----------------------------------------------------------------------------
+size_t unicomm::xml_message_decoder::scanned_length(
+  const comm_buffer::view_type& buffer, session_base& /*session*/)
+{
+  // the tail may hold the beginning of the marker
+  const size_t tail = detail::xml_message_end().size() - 1;
+
+  return buffer.size() > tail? buffer.size() - tail: 0;
+}
+
 //-----------------------------------------------------------------------------
 string& unicomm::xml_message_decoder::decode_raw_message(string& raw_message, 
                                                          session_base& /*session*/)
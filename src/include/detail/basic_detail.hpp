@@ -28,6 +28,13 @@
 #include <string>
 
 #include <cstddef>
+#include <cstring>
+
+#if defined (UNICOMM_AVX2)
+# include <immintrin.h>
+#elif defined (UNICOMM_SSE2)
+# include <emmintrin.h>
+#endif // UNICOMM_AVX2
 
 /** @namespace unicomm Unicomm library root namespace. */
 namespace unicomm
@@ -67,6 +74,92 @@ inline std::string::value_type bin_process_one(std::string::value_type sym)
   return sym ^ 0x40; 
 }
 
+/** Whether character should be escaped by the binary encoding. */
+inline bool is_bin_special_sym(std::string::value_type sym) 
+{ 
+  return is_bin_escape_sym(sym) || is_bin_end_sym(sym); 
+}
+
+/** Returns the first character to be escaped or last if there is no one. 
+ *
+ *  Escape and end symbols are the two greatest byte values, so clean 
+ *  blocks are skipped by a single unsigned compare per byte where 
+ *  SIMD is available.
+ */
+inline const char* find_bin_special_sym(const char* first, const char* last)
+{
+
+#if defined (UNICOMM_AVX2)
+
+  const __m256i threshold = _mm256_set1_epi8(bin_escape_sym());
+
+  for (; last - first >= 32; first += 32)
+  {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    // v >= threshold
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, threshold), v)) != 0)
+    {
+      break;
+    }
+  }
+
+#elif defined (UNICOMM_SSE2)
+
+  const __m128i threshold = _mm_set1_epi8(bin_escape_sym());
+
+  for (; last - first >= 16; first += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    // v >= threshold
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, threshold), v)) != 0)
+    {
+      break;
+    }
+  }
+
+#endif // UNICOMM_AVX2
+
+  // the rest or the block containing the symbol
+  while (first != last && !is_bin_special_sym(*first))
+  {
+    ++first;
+  }
+
+  return first;
+}
+
+/** Returns the first escape symbol or last if there is no one. */
+inline char* find_bin_escape_sym(char* first, char* last)
+{
+  void* p = std::memchr(first, static_cast<unsigned char>(bin_escape_sym()), 
+    last - first);
+
+  return p == 0? last: static_cast<char*>(p);
+}
+
+/** Length prefixed binary message header length. */
+inline size_t bin_lp_header_len(void) { return 4; }
+
+/** Maximum length prefixed binary message length. */
+inline size_t bin_lp_max_len(void) { return 0xffffffffUL; }
+
+/** Writes length prefixed binary message header, network byte order. */
+inline void bin_lp_write_header(char* header, size_t length) 
+{ 
+  header[0] = static_cast<char>((length >> 24) & 0xff);
+  header[1] = static_cast<char>((length >> 16) & 0xff);
+  header[2] = static_cast<char>((length >> 8) & 0xff);
+  header[3] = static_cast<char>(length & 0xff);
+}
+
+/** Reads length prefixed binary message header, network byte order. */
+inline size_t bin_lp_read_header(const char* header) 
+{ 
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(header);
+
+  return (size_t(p[0]) << 24) | (size_t(p[1]) << 16) | (size_t(p[2]) << 8) | p[3];
+}
+
 /** Current decode engine version. */
 inline std::string::value_type bin_version(void) { return 0; }
 
@@ -131,6 +224,54 @@ inline size_t default_incoming_quantum(void) { return 100; }
 /** Outgoing message time quantum in milliseconds. */
 inline size_t default_outgoing_quantum(void) { return 100; }
 
+/** Default pending dispatcher processing passes limit. 
+ *
+ *  This value designates one pending pass per working thread.
+ */
+inline size_t default_pending_kicks(void) { return 0; }
+
+/** Whether pending dispatcher processing passes limit is default. */
+inline bool use_default_pending_kicks(size_t kicks) 
+{ 
+  return kicks == default_pending_kicks(); 
+}
+
+/** Default dispatcher's io services count. */
+inline size_t default_io_services(void) { return 1; }
+
+/** Default maximum incoming message length in bytes, there is no limit. */
+inline size_t default_max_message_length(void) { return 0; }
+
+/** Length prefixed binary message length limit used if there is no other one. */
+inline size_t default_bin_lp_max_length(void) { return 0x1000000; }
+
+/** Default receive buffer size in bytes. */
+inline size_t default_receive_buffer_size(void) { return 0x10000; }
+
+/** Default idle receive buffers limit. */
+inline size_t default_receive_buffer_pool_size(void) { return 64; }
+
+/** Default idle received messages limit per message type, pooling is off. */
+inline size_t default_message_pool_size(void) { return 0; }
+
+/** Default idle communicators limit per io service, pooling is off. */
+inline size_t default_comm_pool_size(void) { return 0; }
+
+/** Default messages per socket write limit. */
+inline size_t default_outgoing_batch_messages(void) { return 64; }
+
+/** Default bytes per socket write limit. */
+inline size_t default_outgoing_batch_bytes(void) { return 0x10000; }
+
+/** Default outgoing stream chunk size in bytes. */
+inline size_t default_stream_chunk_size(void) { return 0x10000; }
+
+/** Default message timeouts resolution in milliseconds. */
+inline size_t default_timeouts_resolution(void) { return 10; }
+
+/** Message timeouts timing wheel slots count. */
+inline size_t timer_wheel_slots(void) { return 512; }
+
 /** Default tcp port value. */
 inline unsigned short default_tcp_port(void) { return 0; }
 
@@ -146,6 +287,18 @@ inline bool use_default_tcp_backlog(int backlog)
   return backlog == default_tcp_backlog(); 
 }
 
+/** Default listening sockets count. */
+inline size_t default_server_acceptors(void) { return 1; }
+
+/** Default pending accepts count per listening socket. */
+inline size_t default_server_pending_accepts(void) { return 1; }
+
+/** Default count of the connections taken by a completed accept. */
+inline size_t default_server_accept_burst(void) { return 16; }
+
+/** Delay in milliseconds before an accept failed for lack of resources is retried. */
+inline size_t accept_retry_timeout(void) { return 100; }
+
 /** Default message encoder. */
 inline message_encoder_base::pointer_type default_message_encoder(void) 
 { 
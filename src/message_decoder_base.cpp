@@ -13,20 +13,127 @@
 // 2010, (c) Dmitry Timoshenko.
 
 #include <unicomm/message_decoder_base.hpp>
+#include <unicomm/message_types.hpp>
 #include <unicomm/except.hpp>
 
 #include <boost/assert.hpp>
 #include <boost/regex.hpp>
 
+#include <algorithm>
+
 using std::string;
 using std::make_pair;
+using std::pair;
 
 using boost::regex;
 using boost::cmatch;
 using boost::regex_match;
 
+//////////////////////////////////////////////////////////////////////////
+// auxiliary
+namespace
+{
+
+typedef pair<const char*, const char*> name_range_type;
+
+//-----------------------------------------------------------------------------
+inline name_range_type name_range(const string& s)
+{
+  return make_pair(s.data(), s.data() + s.size());
+}
+
+//-----------------------------------------------------------------------------
+// the same ordering is used to sort the names and to look them up
+struct name_less
+{
+  bool operator()(const name_range_type& lhs, const name_range_type& rhs) const
+  {
+    return std::lexicographical_compare(lhs.first, lhs.second, 
+      rhs.first, rhs.second);
+  }
+
+  bool operator()(const pair<string, unicomm::message_typeid_type>& lhs, 
+                  const pair<string, unicomm::message_typeid_type>& rhs) const
+  {
+    return (*this)(name_range(lhs.first), name_range(rhs.first));
+  }
+
+  bool operator()(const pair<string, unicomm::message_typeid_type>& lhs, 
+                  const name_range_type& rhs) const
+  {
+    return (*this)(name_range(lhs.first), rhs);
+  }
+};
+
+//-----------------------------------------------------------------------------
+void check_message_name(const unicomm::message_base& message, 
+                        const string& m_name)
+{
+  BOOST_ASSERT(m_name == message.name() && 
+    "It seems invalid type mapped to requested name");
+
+  if (m_name != message.name())
+  {
+    throw unicomm::message_decoder_error("Invalid message received [wanted: " + 
+      message.name() + ", got: " + m_name + "]");
+  }
+}
+
+} // unnamed namespace
+
 //////////////////////////////////////////////////////////////////////////
 // message decoder base
+void unicomm::message_decoder_base::factory(const message_base::factory_type& factory)
+{
+  type_creators_type creators;
+  factory_types_type types;
+
+  for (message_base::factory_type::const_iterator cit = factory.begin(); 
+    cit != factory.end(); ++cit)
+  {
+    const message_typeid_type type = register_message_type(cit->first);
+
+    if (type >= creators.size())
+    {
+      creators.resize(type + 1);
+    }
+
+    creators[type].creator = cit->second;
+    creators[type].name    = cit->first;
+    types.push_back(make_pair(cit->first, type));
+  }
+
+  std::sort(types.begin(), types.end(), name_less());
+
+  _factory = factory;
+  _type_creators.swap(creators);
+  _factory_types.swap(types);
+
+  // pool is indexed by the types
+  message_pool_size(_message_pool_size);
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::message_decoder_base::message_pool_size(size_t n)
+{
+  _message_pool_size = n;
+  _pool.reset(n == 0? 0: new message_pool(_type_creators.size(), n));
+}
+
+//-----------------------------------------------------------------------------
+unicomm::message_typeid_type 
+unicomm::message_decoder_base::find_factory_type(const char* first, 
+                                                 const char* last) const
+{
+  const name_range_type name = make_pair(first, last);
+  const factory_types_type::const_iterator cit = std::lower_bound(
+    _factory_types.begin(), _factory_types.end(), name, name_less());
+
+  return cit == _factory_types.end() || name_less()(name, name_range(cit->first))? 
+    undefined_message_typeid(): cit->second;
+}
+
+//-----------------------------------------------------------------------------
 unicomm::message_base::pointer_type 
 unicomm::message_decoder_base::perform_decode(comm_buffer& buffer, 
                                               session_base& session)
@@ -34,33 +141,51 @@ unicomm::message_decoder_base::perform_decode(comm_buffer& buffer,
   unicomm::message_base::pointer_type message;
   // find message bounds
   comm_buffer::buffer_lock lock(buffer);
-  const iter_pair_type bounds = find_raw_message(lock.buffer(), session);
+  const comm_buffer::view_type view = lock.view();
+  const iter_pair_type bounds = find_raw_message(view, session);
 
   if (bounds.first != bounds.second)
   {
     BOOST_ASSERT(bounds.first < bounds.second && "Invalid iterators range");
+    BOOST_ASSERT(view.begin() <= bounds.first && bounds.second <= view.end() && 
+      "Message is out of the buffer");
 
     string m_str(bounds.first, bounds.second);
-    lock.buffer().erase(bounds.first, bounds.second);
+    // only the head is removed, the rest of the data stays in place
+    lock.consume(bounds.second - view.begin());
     lock.unlock();
 
-    const string m_name = 
-      get_message_name(decode_raw_message(m_str, session), session);
+    decode_raw_message(m_str, session);
+
+    const message_typeid_type type = get_message_type(m_str, session);
 
-    message = create_message(m_name, session);
+    if (type != undefined_message_typeid())
+    {
+      message = create_message(type, session);
 
-    BOOST_ASSERT(m_name == message->name() && 
-      "It seems invalid type mapped to requested name");
+      check_message_name(*message, 
+        type < _type_creators.size() && !_type_creators[type].name.empty()? 
+          _type_creators[type].name: message_type_name(type));
 
-    if (m_name != message->name())
+      // the message carries its type, so it's not looked up by the name
+      message->type_id(type);
+    } else
     {
-      throw message_decoder_error("Invalid message received [wanted: " + 
-        message->name() + ", got: " + m_name + "]");
+      // unknown name is passed to the factory, it may have default creator
+      const string m_name = get_message_name(m_str, session);
+
+      message = create_message(m_name, session);
+
+      check_message_name(*message, m_name);
     }
 
     // fixme: what if decoder encounters error? clear income buffer? or what?
     // e.g. if message::unserialize throw...
     message->unserialize(m_str);
+  } else
+  {
+    // next time resume where stopped
+    lock.scanned(scanned_length(view, session));
   }
 
   return message;
@@ -74,3 +199,29 @@ unicomm::message_decoder_base::create_message(const string& name,
   return _factory.create(name);
 }
 
+//-----------------------------------------------------------------------------
+unicomm::message_base::pointer_type 
+unicomm::message_decoder_base::create_message(message_typeid_type type, 
+                                              session_base& session)
+{
+  if (type < _type_creators.size() && _type_creators[type].creator)
+  {
+    const message_base::factory_type::creator_type& creator = 
+      _type_creators[type].creator;
+
+    return _pool? _pool->acquire(type, creator): creator();
+  }
+
+  return create_message(message_type_name(type), session);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::message_typeid_type 
+unicomm::message_decoder_base::get_message_type(const string& raw_message, 
+                                                session_base& session)
+{
+  const string name = get_message_name(raw_message, session);
+
+  return find_factory_type(name.data(), name.data() + name.size());
+}
+
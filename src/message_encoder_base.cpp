@@ -24,6 +24,9 @@ unicomm::message_encoder_base::perform_encode(const message_base& message,
 {
   out_buffer_type out_buf = message.serialize();
 
-  return encode_raw_message(out_buf, session);
+  encode_raw_message(out_buf, session);
+
+  // the local is returned by name, so the data is not copied
+  return out_buf;
 }
 
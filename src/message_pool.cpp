@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// message_pool.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Pool of the message objects created by the decoder.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/message_pool.hpp>
+#include <unicomm/detail/pool_detail.hpp>
+
+#include <boost/assert.hpp>
+
+//////////////////////////////////////////////////////////////////////////
+// type pool
+class unicomm::message_pool::type_pool : 
+  public detail::idle_list<message_base::pointer_type>
+{
+public:
+  explicit type_pool(size_t max_idle): 
+    detail::idle_list<message_base::pointer_type>(max_idle) 
+  { 
+    // empty
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// message pool
+unicomm::message_pool::message_pool(size_t types, size_t max_idle):
+  _max_idle(max_idle)
+{
+  BOOST_ASSERT(max_idle > 0 && " - Pool should hold at least one object");
+
+  _pools.reserve(types);
+  for (size_t i = 0; i < types; ++i)
+  {
+    _pools.push_back(type_pool_ptr(new type_pool(max_idle)));
+  }
+}
+
+//-----------------------------------------------------------------------------
+unicomm::message_base::pointer_type
+unicomm::message_pool::acquire(message_typeid_type type,
+                               const creator_type& creator)
+{
+  if (type >= _pools.size())
+  {
+    return creator();
+  }
+
+  const type_pool_ptr& pool = _pools[type];
+
+  message_base::pointer_type m;
+  if (pool->acquire(m))
+  {
+    m->reset();
+  } else
+  {
+    // create outside the lock
+    m = creator();
+    pool->created();
+
+    if (m && !m->resettable())
+    {
+      // the state of the message can't be restored, so it isn't reused
+      return m;
+    }
+  }
+
+  // the message object is owned by the recycler, so it returns to the pool
+  return m? detail::lend(m.get(), pool, m): m;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::message_pool::idle_count(message_typeid_type type) const
+{
+  return type < _pools.size()? _pools[type]->idle_count(): 0;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::message_pool::hits(message_typeid_type type) const
+{
+  return type < _pools.size()? _pools[type]->hits(): 0;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::message_pool::misses(message_typeid_type type) const
+{
+  return type < _pools.size()? _pools[type]->misses(): 0;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::message_pool::hits(void) const
+{
+  size_t n = 0;
+
+  for (type_pools_type::const_iterator cit = _pools.begin(); cit != _pools.end(); ++cit)
+  {
+    n += (*cit)->hits();
+  }
+
+  return n;
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::message_pool::misses(void) const
+{
+  size_t n = 0;
+
+  for (type_pools_type::const_iterator cit = _pools.begin(); cit != _pools.end(); ++cit)
+  {
+    n += (*cit)->misses();
+  }
+
+  return n;
+}
@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// message_stream.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Outgoing data produced by chunks.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/message_stream.hpp>
+#include <unicomm/except.hpp>
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+
+using std::string;
+using std::ifstream;
+using std::streamsize;
+
+using boost::uintmax_t;
+
+//////////////////////////////////////////////////////////////////////////
+// file stream
+unicomm::file_stream::file_stream(const string& file_name,
+                                  uintmax_t offset,
+                                  uintmax_t length):
+  _file(file_name.c_str(), ifstream::binary),
+  _file_name(file_name),
+  _left(0)
+{
+  if (!_file)
+  {
+    throw message_stream_error("Can't open file [" + file_name + "]");
+  }
+
+  _file.seekg(0, ifstream::end);
+  const uintmax_t size = static_cast<uintmax_t>(_file.tellg());
+
+  _file.seekg(static_cast<ifstream::off_type>(std::min(offset, size)), ifstream::beg);
+  if (!_file)
+  {
+    throw message_stream_error("Can't seek file [" + file_name + "]");
+  }
+
+  _left = offset < size? std::min(length, size - offset): 0;
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::file_stream::read_chunk(out_buffer_type& chunk, size_t max_size)
+{
+  BOOST_ASSERT(max_size > 0 && " - Chunk size can't be zero");
+
+  const size_t n = static_cast<size_t>(std::min(_left, uintmax_t(max_size)));
+
+  chunk.resize(n);
+  if (n == 0)
+  {
+    return;
+  }
+
+  _file.read(&chunk[0], static_cast<streamsize>(n));
+  if (static_cast<size_t>(_file.gcount()) != n)
+  {
+    throw message_stream_error("Can't read file [" + _file_name + "]");
+  }
+
+  _left -= n;
+}
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// message_types.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Message types registry.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/message_types.hpp>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <map>
+
+using std::string;
+
+using boost::mutex;
+
+//////////////////////////////////////////////////////////////////////////
+// registry
+namespace
+{
+
+class message_types_registry : private boost::noncopyable
+{
+public:
+  unicomm::message_typeid_type register_type(const string& name)
+  {
+    mutex::scoped_lock lock(_mutex);
+
+    const types_map_type::const_iterator cit = _types.find(name);
+    if (cit != _types.end())
+    {
+      return cit->second;
+    }
+
+    const unicomm::message_typeid_type type = _names.size();
+
+    // deque doesn't move elements on growth,
+    // so the references to the names stay valid
+    _names.push_back(name);
+    _types.insert(std::make_pair(name, type));
+
+    return type;
+  }
+
+  unicomm::message_typeid_type find(const string& name) const
+  {
+    mutex::scoped_lock lock(_mutex);
+
+    const types_map_type::const_iterator cit = _types.find(name);
+
+    return cit == _types.end()? unicomm::undefined_message_typeid(): cit->second;
+  }
+
+  const string& name(unicomm::message_typeid_type type) const
+  {
+    static const string empty;
+
+    mutex::scoped_lock lock(_mutex);
+
+    return type < _names.size()? _names[type]: empty;
+  }
+
+private:
+  typedef std::map<string, unicomm::message_typeid_type> types_map_type;
+  typedef std::deque<string> names_type;
+
+private:
+  mutable mutex _mutex;
+  types_map_type _types;
+  names_type _names;
+};
+
+//-----------------------------------------------------------------------------
+message_types_registry& registry(void)
+{
+  static message_types_registry r;
+
+  return r;
+}
+
+} // unnamed namespace
+
+//////////////////////////////////////////////////////////////////////////
+// message types
+unicomm::message_typeid_type unicomm::register_message_type(const string& name)
+{
+  return registry().register_type(name);
+}
+
+//-----------------------------------------------------------------------------
+unicomm::message_typeid_type unicomm::find_message_type(const string& name)
+{
+  return registry().find(name);
+}
+
+//-----------------------------------------------------------------------------
+const string& unicomm::message_type_name(message_typeid_type type)
+{
+  return registry().name(type);
+}
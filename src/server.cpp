@@ -18,21 +18,73 @@
 #include <detail/basic_detail.hpp>
 
 #include <smart/debug_out.hpp>
-#include <smart/scoped_sentinel.hpp>
 
 #include <boost/bind.hpp>
 
+#include <algorithm>
+
 using boost::asio::ip::tcp;
 using boost::asio::socket_base;
 
-using smart::scoped_sentinel;
+//////////////////////////////////////////////////////////////////////////
+// aux
+namespace
+{
+
+#ifdef SO_REUSEPORT
+
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> 
+  reuse_port;
+
+#endif // SO_REUSEPORT
+
+//------------------------------------------------------------------------
+size_t acceptors_count(const unicomm::config& conf)
+{
+  const size_t n = std::max(conf.server_acceptors(), size_t(1));
+
+#ifdef SO_REUSEPORT
+
+  return n;
+
+#else // SO_REUSEPORT
+
+  // several sockets can't be bound to the same endpoint
+  return std::min(n, size_t(1));
+
+#endif // SO_REUSEPORT
+}
+
+//------------------------------------------------------------------------
+inline size_t pending_accepts(const unicomm::config& conf)
+{
+  return std::max(conf.server_pending_accepts(), size_t(1));
+}
+
+//------------------------------------------------------------------------
+inline size_t accept_burst(const unicomm::config& conf)
+{
+  return std::max(conf.server_accept_burst(), size_t(1));
+}
+
+//------------------------------------------------------------------------
+// the connection stays in the backlog until descriptors or memory are freed
+inline bool is_out_of_resources(const boost::system::error_code& error)
+{
+  return error == boost::asio::error::no_descriptors ||
+    error == boost::system::errc::too_many_files_open_in_system ||
+    error == boost::asio::error::no_buffer_space ||
+    error == boost::asio::error::no_memory;
+}
+
+} // unnamed namespace
 
 //////////////////////////////////////////////////////////////////////////
 // unicomm server
 unicomm::server::server(const unicomm::config& config):
   dispatcher(config)
 {
-  constructor();
+  constructor(config.listen_endpoints());
 }
 
 //-----------------------------------------------------------------------------
@@ -40,7 +92,15 @@ unicomm::server::server(const unicomm::config& config,
                         const tcp::endpoint &listen_endpoint):
   dispatcher(config, listen_endpoint)
 {
-  constructor();
+  constructor(endpoints_type(1, listen_endpoint));
+}
+
+//-----------------------------------------------------------------------------
+unicomm::server::server(const unicomm::config& config, 
+                        const endpoints_type &listen_endpoints):
+  dispatcher(config)
+{
+  constructor(listen_endpoints);
 }
 
 //-----------------------------------------------------------------------------
@@ -121,6 +181,8 @@ void unicomm::server::initialize(void)
   // create listening socket
   //create_listening_socket();
   create_acceptor();
+  // communicators for the connections to come
+  reserve_comms<server_communicator>();
   //// allow to setup acceptor
   //before_start(acceptor());
 }
@@ -148,12 +210,18 @@ void unicomm::server::on_stop(void)
 //-----------------------------------------------------------------------------
 bool unicomm::server::is_acceptor(void) const
 {
-  return _acceptor != 0;
+  return !_listeners.empty();
 }
 
 //-----------------------------------------------------------------------------
-void unicomm::server::constructor(void)
+void unicomm::server::constructor(const endpoints_type& listen_endpoints)
 {
+  _listen_endpoints = listen_endpoints;
+  if (_listen_endpoints.empty())
+  {
+    _listen_endpoints.push_back(endpoint());
+  }
+
   initialize();
 }
 
@@ -167,22 +235,150 @@ void unicomm::server::just_start_accept(void)
 
   open_acceptor();
 
-  comm_ptr client = create_comm<server_communicator>();
+  const size_t pending = pending_accepts(config());
 
-  UNICOMM_DEBUG_OUT("[unicomm::server]: New comm created; comm ID = " 
-    << std::dec << client->id())
+  for (size_t i = 0; i < _listeners.size(); ++i)
+  {
+    for (size_t k = 0; k < pending; ++k)
+    {
+      // accepts on the socket are only started through its strand
+      _listeners[i].strand().post(boost::bind(&server::accept_one, this, i));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::server::accept_one(size_t index)
+{
+  accept_into(index, comm_ptr());
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::server::accept_into(size_t index, const comm_ptr& spare)
+{
+  // the socket could have been closed while the call was waiting
+  if (index >= _listeners.size() || !_listeners[index].acceptor().is_open())
+  {
+    UNICOMM_DEBUG_OUT("[unicomm::server]: Accept is skipped, listening socket " 
+      << "is closed; index = " << index)
+
+    return;
+  }
+
+  const listener& l = _listeners[index];
+  const comm_ptr client = spare? spare: create_accepted_comm(index);
 
   // fixme: incapsulate async_accept() & async_connect() by communicator
-  acceptor().async_accept(client->socket(), 
-    boost::bind(&server::asio_accept_handler, this, client,
-      boost::asio::placeholders::error));
+  l.acceptor().async_accept(client->socket(), 
+    l.strand().wrap(boost::bind(&server::asio_accept_handler, this, index, 
+      client, boost::asio::placeholders::error)));
+}
+
+//-----------------------------------------------------------------------------
+unicomm::server::comm_ptr unicomm::server::create_accepted_comm(size_t index)
+{
+  // a connection stays on the io service of the socket it's accepted by, 
+  // the only socket per endpoint spreads them across all the io services
+  comm_ptr client = acceptors_count(config()) > 1? 
+    create_comm<server_communicator>(_listeners[index].ioservice_index()): 
+    create_comm<server_communicator>();
+
+  UNICOMM_DEBUG_OUT("[unicomm::server]: New comm created; comm ID = " 
+    << std::dec << client->id() << "; listener = " << index)
+
+  return client;
+}
+
+//-----------------------------------------------------------------------------
+unicomm::server::comm_ptr 
+unicomm::server::take_backlog(size_t index, comm_sequence_type& clients)
+{
+  const size_t burst = accept_burst(config());
+  tcp::acceptor& a = _listeners[index].acceptor();
+
+  comm_ptr client;
+
+  // the socket is non-blocking, so the backlog is taken 
+  // without waiting for the next readiness notification
+  while (clients.size() < burst && a.is_open())
+  {
+    if (!client)
+    {
+      client = create_accepted_comm(index);
+    }
+
+    boost::system::error_code error;
+
+    a.accept(client->socket(), error);
+    if (error)
+    {
+      UNICOMM_DEBUG_OUT("[unicomm::server]: Backlog is taken; accepted = " 
+        << clients.size() << "; [" << error << ", " << error.message() << "]")
+
+      break;
+    }
+
+    clients.push_back(client);
+    client.reset();
+  }
+
+  // communicator created for the accept that found nothing
+  return client;
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::server::retry_accept(size_t index, const comm_ptr& spare)
+{
+  if (index >= _listeners.size())
+  {
+    return;
+  }
+
+  const listener& l = _listeners[index];
+  const retry_timer_ptr_type timer(
+    new retry_timer_ptr_type::element_type(ioservice(l.ioservice_index())));
+
+  UNICOMM_DEBUG_OUT("[unicomm::server]: Accept is retried in " 
+    << detail::accept_retry_timeout() << " ms; listener = " << index)
+
+  timer->expires_from_now(
+    boost::asio::chrono::milliseconds(detail::accept_retry_timeout()));
+  timer->async_wait(l.strand().wrap(boost::bind(
+    &server::asio_retry_accept_handler, this, index, spare, timer, 
+      boost::asio::placeholders::error)));
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::server::start_accepted(const comm_ptr& client)
+{
+  // call virtual
+  call_after_accept(client->socket());
+
+#ifdef UNICOMM_SSL
+
+  // perform handshake 
+  client->asio_success_connect_handler(bind( // -> client->ssl_socket().async_handshake(...)
+    &server::asio_handshake_handler, this, client, boost::asio::placeholders::error)); 
+
+#else // UNICOMM_SSL
+
+  // make client know that it is just connected
+  client->asio_success_connect_handler(); // -> client->just_connected(true);
+  
+#endif // UNICOMM_SSL
+
+  // tell to process
+  kick_dispatcher(*client);
+
+  UNICOMM_DEBUG_OUT("[unicomm::server]: Client accepted; comm ID = " 
+    << std::dec << client->id() << "; remote ep = " << client->remote_endpoint())
 }
 
 //-----------------------------------------------------------------------------
 void unicomm::server::create_listening_socket(void)
 {
-  UNICOMM_DEBUG_OUT("[unicomm::server]: Creating listening socket; binding to [" 
-    << endpoint() << "]")
+  UNICOMM_DEBUG_OUT("[unicomm::server]: Creating listening sockets; endpoints = " 
+    << _listen_endpoints.size())
 
   create_acceptor();
   open_acceptor();
@@ -191,7 +387,20 @@ void unicomm::server::create_listening_socket(void)
 //-----------------------------------------------------------------------------
 void unicomm::server::create_acceptor(void)
 {
-  _acceptor.reset(new acceptor_ptr_type::element_type(ioservice()));
+  const size_t n = acceptors_count(config());
+
+  _listeners.clear();
+  for (endpoints_type::const_iterator cit = _listen_endpoints.begin(); 
+    cit != _listen_endpoints.end(); ++cit)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      // listening sockets are assigned to the io services in turn
+      const size_t index = _listeners.size() % ioservices_count();
+
+      _listeners.push_back(listener(ioservice(index), index, *cit));
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -199,18 +408,47 @@ void unicomm::server::open_acceptor(void)
 {
   BOOST_ASSERT(is_acceptor() && " - Acceptor should exist");
 
-  if (!is_acceptor_opened())
+  const int backlog = detail::use_default_tcp_backlog(config().tcp_backlog())? 
+    socket_base::max_connections: config().tcp_backlog();
+
+  for (listeners_type::const_iterator cit = _listeners.begin(); 
+    cit != _listeners.end(); ++cit)
   {
-    UNICOMM_DEBUG_OUT("[unicomm::server]: Opening listening socket; binding to [" 
-      << endpoint() << "]")
+    tcp::acceptor& a = cit->acceptor();
+
+    if (!a.is_open())
+    {
+      UNICOMM_DEBUG_OUT("[unicomm::server]: Opening listening socket; binding to [" 
+        << cit->endpoint() << "]; io service = " << cit->ioservice_index())
+
+      a.open(cit->endpoint().protocol());
 
-    acceptor().open(tcp::v4());
-    acceptor().bind(endpoint()); // fixme: can acceptor be rebinded?
+      // dual-stack unless told otherwise
+      if (cit->endpoint().address().is_v6())
+      {
+        a.set_option(boost::asio::ip::v6_only(config().server_ipv6_only()));
+      }
 
-    const int backlog = detail::use_default_tcp_backlog(config().tcp_backlog())? 
-      socket_base::max_connections: config().tcp_backlog();
+#ifdef SO_REUSEPORT
 
-    acceptor().listen(backlog);
+      // the system spreads the connections across the sockets
+      if (acceptors_count(config()) > 1)
+      {
+        a.set_option(reuse_port(true));
+      }
+
+#endif // SO_REUSEPORT
+
+      a.bind(cit->endpoint()); // fixme: can acceptor be rebinded?
+      a.listen(backlog);
+
+      // the backlog is taken by non-blocking accepts, 
+      // the asynchronous ones aren't affected
+      if (accept_burst(config()) > 1)
+      {
+        a.non_blocking(true);
+      }
+    }
   }
 }
 
@@ -219,15 +457,19 @@ void unicomm::server::close_acceptor(void)
 {
   BOOST_ASSERT(is_acceptor() && " - Acceptor should exist");
 
-  if (is_acceptor_opened())
+  for (listeners_type::const_iterator cit = _listeners.begin(); 
+    cit != _listeners.end(); ++cit)
   {
-    try
+    if (cit->acceptor().is_open())
     {
-      acceptor().close();
-    } catch (const std::exception& UNICOMM_IFDEF_DEBUG(e))
-    {
-      UNICOMM_DEBUG_OUT("[unicomm::server]: Acceptor closing has risen an " 
-        << "std::exception [" << e.what() << "]")
+      try
+      {
+        cit->acceptor().close();
+      } catch (const std::exception& UNICOMM_IFDEF_DEBUG(e))
+      {
+        UNICOMM_DEBUG_OUT("[unicomm::server]: Acceptor closing has risen an " 
+          << "std::exception [" << e.what() << "]")
+      }
     }
   }
 }
@@ -242,7 +484,7 @@ void unicomm::server::destroy_acceptor(void)
   {
     close_acceptor();
 
-    _acceptor.reset();
+    _listeners.clear();
   }
   
   UNICOMM_DEBUG_OUT("[unicomm::server]: EXIT; Destroying listening socket; " 
@@ -277,7 +519,7 @@ boost::asio::ip::tcp::acceptor& unicomm::server::acceptor(void)
 {
   BOOST_ASSERT(is_acceptor() && " - Acceptor is invalid");
 
-  return *_acceptor;
+  return _listeners.front().acceptor();
 }
 
 //-----------------------------------------------------------------------------
@@ -300,7 +542,8 @@ void unicomm::server::stop_accept(void)
 }
 
 //-----------------------------------------------------------------------------
-void unicomm::server::asio_accept_handler(const comm_ptr& client, 
+void unicomm::server::asio_accept_handler(size_t index,
+                                          const comm_ptr& client, 
                                           const boost::system::error_code& error)
 {
   UNICOMM_DEBUG_OUT("[unicomm::server]: Asio accept handler invoked; comm ID = " 
@@ -310,41 +553,66 @@ void unicomm::server::asio_accept_handler(const comm_ptr& client,
   {
     UNICOMM_DEBUG_OUT("[unicomm::server]: Accept error [" << error << ", " 
       << error.message() << "]")
-    // fixme: what to do here? how many times to start accept if errors?
-    //just_start_accept();
+
+    // every pending accept is restarted, otherwise the server loses 
+    // one on each error; the communicator is left unused, so it's reused
+    if (error == boost::asio::error::operation_aborted)
+    {
+      // the socket is closed, accepting is stopped
+    } else if (is_out_of_resources(error))
+    {
+      // retrying immediately would spin while the backlog is not empty
+      retry_accept(index, client);
+    } else
+    {
+      // the error only concerns the connection being accepted
+      accept_into(index, client);
+    }
   } else
   {
-    // start new accept anyway
-    scoped_sentinel accept_sentry(boost::bind(&server::just_start_accept, this));
-    // add client
-    insert_comm(client);
-    // call virtual
-    call_after_accept(client->socket());
-
-#ifdef UNICOMM_SSL
+    comm_sequence_type clients(1, client);
+    comm_ptr spare;
 
-    // perform handshake 
-    client->asio_success_connect_handler(bind( // -> client->ssl_socket().async_handshake(...)
-      &server::asio_handshake_handler, this, client, boost::asio::placeholders::error)); 
-
-#else // UNICOMM_SSL
-
-    // make client know that it is just connected
-    client->asio_success_connect_handler(); // -> client->just_connected(true);
-    
-#endif // UNICOMM_SSL
+    // the socket could have been closed while the handler was waiting
+    if (index < _listeners.size())
+    {
+      // take the rest of the backlog while the socket is ready
+      spare = take_backlog(index, clients);
+    }
 
-    // tell to process
-    kick_dispatcher();
+    // start new accept before the clients are processed, 
+    // the communicator left from the backlog is used by it
+    accept_into(index, spare);
+    // add clients
+    insert_comms(clients);
 
-    UNICOMM_DEBUG_OUT("[unicomm::server]: Client accepted; comm ID = " 
-      << std::dec << client->id() << "; remote ep = " << client->remote_endpoint())
+    for (comm_sequence_type::const_iterator cit = clients.begin(); 
+      cit != clients.end(); ++cit)
+    {
+      start_accepted(*cit);
+    }
   }
 
   UNICOMM_DEBUG_OUT("[unicomm::server]: Asio accept handler finished; comm ID = " 
     << std::dec << client->id() << "; [" << error << ", " << error.message() << "]")
 }
 
+//-----------------------------------------------------------------------------
+void unicomm::server::asio_retry_accept_handler(size_t index, 
+                                                const comm_ptr& spare, 
+                                                const retry_timer_ptr_type& /*timer*/, 
+                                                const boost::system::error_code& error)
+{
+  if (error)
+  {
+    UNICOMM_DEBUG_OUT("[unicomm::server]: Accept retry timer error [" << error 
+      << ", " << error.message() << "]")
+  } else
+  {
+    accept_into(index, spare);
+  }
+}
+
 #ifdef UNICOMM_SSL
 
 //-----------------------------------------------------------------------------
@@ -53,7 +53,8 @@ unicomm::server_communicator::~server_communicator(void)
 void unicomm::server_communicator::asio_success_connect_handler(
   const asio_handshake_handler_type& handler) 
 {
-  ssl_socket().async_handshake(boost::asio::ssl::stream_base::server, handler);
+  ssl_socket().async_handshake(boost::asio::ssl::stream_base::server, 
+    strand().wrap(handler));
 }
 
 #endif // UNICOMM_SSL
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// timer_wheel.cpp
+//
+// unicomm - Unified Communication protocol C++ library.
+//
+// Hashed timing wheel serving message timeouts.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// 2013, (c) Dmitry Timoshenko.
+
+#include <unicomm/timer_wheel.hpp>
+
+#include <boost/assert.hpp>
+
+using boost::mutex;
+
+//////////////////////////////////////////////////////////////////////////
+// timer_wheel
+unicomm::timer_wheel::timer_wheel(size_t resolution, size_t slots):
+  _slots(slots),
+  _current(0),
+  _size(0),
+  _resolution(resolution)
+{
+  BOOST_ASSERT(resolution > 0 && " - Resolution can't be zero");
+  BOOST_ASSERT(slots > 0 && " - Slots count can't be zero");
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::timer_wheel::schedule(const comm_pointer_type& comm,
+                                    messageid_type mid,
+                                    size_t serial,
+                                    size_t tout)
+{
+  // the tick in progress is partially passed, so it isn't counted
+  const size_t ticks = (tout + _resolution - 1) / _resolution + 1;
+
+  mutex::scoped_lock lock(_mutex);
+
+  const size_t slot = (_current + ticks - 1) % _slots.size();
+
+  _slots[slot].push_back(entry(comm, mid, serial, (ticks - 1) / _slots.size()));
+  ++_size;
+}
+
+//-----------------------------------------------------------------------------
+void unicomm::timer_wheel::advance(entries_type& expired)
+{
+  mutex::scoped_lock lock(_mutex);
+
+  entries_type& slot = _slots[_current];
+
+  entries_type::iterator kept = slot.begin();
+  for (entries_type::iterator it = slot.begin(); it != slot.end(); ++it)
+  {
+    if (it->_rounds == 0)
+    {
+      expired.push_back(*it);
+    } else
+    {
+      --it->_rounds;
+      *kept++ = *it;
+    }
+  }
+
+  _size -= slot.end() - kept;
+  slot.erase(kept, slot.end());
+
+  _current = (_current + 1) % _slots.size();
+}
+
+//-----------------------------------------------------------------------------
+size_t unicomm::timer_wheel::size(void) const
+{
+  mutex::scoped_lock lock(_mutex);
+
+  return _size;
+}
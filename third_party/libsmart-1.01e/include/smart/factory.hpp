@@ -65,6 +65,13 @@ public:
   /** Key type which creators are mapped to. */
   typedef KeyT key_type;
 
+private:
+  typedef std::map<key_type, creator_type> creators_collection_type;
+
+public:
+  /** Registered creators iterator, points to a pair of key and creator. */
+  typedef typename creators_collection_type::const_iterator const_iterator;
+
   /** Easy init. */
   //typedef factory_easy_init<created_type, key_type> easy_init_type;
   
@@ -84,6 +91,15 @@ public:
   /** Whether factory is empty. */
   bool empty(void) const { return _creators.empty(); }
 
+  /** Returns the beginning of the registered creators. */
+  const_iterator begin(void) const { return _creators.begin(); }
+
+  /** Returns the end of the registered creators. */
+  const_iterator end(void) const { return _creators.end(); }
+
+  /** Returns default creator, may be null. */
+  const creator_type& default_creator(void) const { return _default_creator; }
+
   /** Register new creator or overwrite existing. 
    *
    *  @return *this;
@@ -136,9 +152,6 @@ public:
 
 //////////////////////////////////////////////////////////////////////////
 // private section
-private:
-  typedef std::map<key_type, creator_type> creators_collection_type;
-
 private:
   creators_collection_type _creators;
   creator_type _default_creator;
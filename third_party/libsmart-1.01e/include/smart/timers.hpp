@@ -39,6 +39,14 @@
 namespace smart
 {
 
+/** Returns current time of the monotonic clock. 
+ *
+ *  The clock never goes back and isn't affected by the system time 
+ *  changes. The value has nothing to do with the calendar time, 
+ *  it's only meaningful to measure intervals.
+ */
+boost::posix_time::ptime monotonic_time(void);
+
 /** Simple timeout class. */
 struct timeout
 {
@@ -49,9 +57,13 @@ public:
   static const boost::posix_time::time_duration& infinite_timeout(void);
 
 public:
-  /** Constructs timeout object. */
+  /** Constructs timeout object. 
+   *
+   *  @param tout Timeout duration.
+   *  @param start Start time, should be got by smart::monotonic_time().
+   */
   explicit timeout(const boost::posix_time::time_duration& tout = infinite_timeout(), 
-    const boost::posix_time::ptime& start = boost::posix_time::microsec_clock::local_time()): 
+    const boost::posix_time::ptime& start = monotonic_time()):  
     _start(start),
     _tout(tout)
   {
@@ -80,7 +92,7 @@ private:
 };
 
 /** Resets timeout start to now. */
-inline void reset(timeout& tout) { tout.start_time(boost::posix_time::microsec_clock::local_time()); }
+inline void reset(timeout& tout) { tout.start_time(monotonic_time()); }
 
 } // namespace smart
 
@@ -13,6 +13,16 @@
 
 #include <smart/timers.hpp>
 
+#include <boost/cstdint.hpp>
+
+#ifdef SMART_WIN
+# include <windows.h>
+#elif defined SMART_MACOS
+# include <mach/mach_time.h>
+#else
+# include <time.h>
+#endif
+
 //#ifdef _MSC_VER
 //  #pragma warning (push)
 //  #pragma warning (disable : 4511) // copy constructor could not be generated
@@ -27,17 +37,67 @@
 //  #pragma warning (pop)
 //#endif
 
+////////////////////////////////////////////////////////////////////////////////
+// monotonic clock
+namespace
+{
+
+/** Returns monotonic clock ticks in microseconds. */
+boost::int64_t monotonic_microseconds(void)
+{
+#ifdef SMART_WIN
+
+  static LARGE_INTEGER frequency = { 0 };
+  if (frequency.QuadPart == 0)
+  {
+    QueryPerformanceFrequency(&frequency);
+  }
+
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+
+  return counter.QuadPart / frequency.QuadPart * 1000000 + 
+    counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart;
+
+#elif defined SMART_MACOS
+
+  static mach_timebase_info_data_t timebase = { 0, 0 };
+  if (timebase.denom == 0)
+  {
+    mach_timebase_info(&timebase);
+  }
+
+  return boost::int64_t(mach_absolute_time() * timebase.numer / timebase.denom / 1000);
+
+#else
+
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return boost::int64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+
+#endif // SMART_WIN
+}
+
+} // unnamed namespace
+
+//------------------------------------------------------------------------------
+boost::posix_time::ptime smart::monotonic_time(void)
+{
+  // arbitrary fixed origin, no calendar or time zone calculations involved
+  static const boost::posix_time::ptime origin(boost::gregorian::date(2000, 1, 1));
+
+  return origin + boost::posix_time::microseconds(monotonic_microseconds());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // timeout
 
 //------------------------------------------------------------------------------
 bool smart::timeout::elapsed(void) const 
 { 
-  const boost::posix_time::ptime finish = finish_time();
-  const boost::posix_time::ptime now    = boost::posix_time::microsec_clock::local_time();
-
-  //return _tout == uni_config::infinite_timeout? false: boost::posix_time::microsec_clock::local_time() > finishtime(); 
-  return _tout == infinite_timeout() ? false : now > finish; 
+  // infinite one never elapses, don't read the clock
+  return _tout == infinite_timeout() ? false : monotonic_time() > finish_time();  
 }
 
 //------------------------------------------------------------------------------